@@ -0,0 +1,86 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012 Openismus GmbH. All rights reserved.
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "models/imageatlas.h"
+#include "view/imageatlascomposer.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QImage>
+#include <QStringList>
+
+// Packs the images of a style profile into one atlas image, and writes the
+// coordinate table read by Style, see ImageAtlas.
+int main(int argc,
+         char ** argv)
+{
+    QCoreApplication app(argc, argv);
+    const QStringList arguments(app.arguments());
+
+    if (arguments.size() != 3) {
+        qWarning("Usage: %s <images directory> <output directory>",
+                 qPrintable(arguments.first()));
+        return 1;
+    }
+
+    const QString input_path(arguments.at(1));
+    const QDir output_dir(arguments.at(2));
+
+    if (not QDir().mkpath(output_dir.absolutePath())) {
+        qWarning("Could not create %s", qPrintable(output_dir.absolutePath()));
+        return 1;
+    }
+
+    MaliitKeyboard::ImageAtlas atlas;
+    const QImage image(MaliitKeyboard::composeImageAtlas(input_path, &atlas));
+
+    if (image.isNull()) {
+        qWarning("No images found in %s", qPrintable(input_path));
+        return 1;
+    }
+
+    const QString image_path(output_dir.absoluteFilePath(MaliitKeyboard::ImageAtlasImageFileName));
+    const QString table_path(output_dir.absoluteFilePath(MaliitKeyboard::ImageAtlasTableFileName));
+
+    if (not image.save(image_path, "PNG")) {
+        qWarning("Could not write %s", qPrintable(image_path));
+        return 1;
+    }
+
+    atlas.setFileName(image_path);
+
+    if (not atlas.save(table_path)) {
+        qWarning("Could not write %s", qPrintable(table_path));
+        return 1;
+    }
+
+    return 0;
+}
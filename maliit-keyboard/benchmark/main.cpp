@@ -33,15 +33,308 @@
 
 
 #include "logic/layoutupdater.h"
+#include "logic/layouthelper.h"
+#include "logic/eventhandler.h"
+#include "logic/hitlogic.h"
+#include "logic/keyboardbuilder.h"
+#include "logic/keyareaconverter.h"
+#include "logic/style.h"
+#include "models/keyarea.h"
+#include "models/layout.h"
+#include "models/keystyletable.h"
+#include "parser/layoutparser.h"
+#include "coreutils.h"
 
 #include <cstdlib>
 #include <ctime>
 #include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
 
+namespace {
+
+// Parses every language file rounds times and reports parse times and how
+// the parse trees are laid out in memory.
+int benchmarkParsing(int rounds)
+{
+    const QDir dir(MaliitKeyboard::CoreUtils::pluginDataDirectory() + "/languages",
+                   "*.xml", QDir::Name, QDir::Files | QDir::Readable);
+    const QFileInfoList file_infos(dir.entryInfoList());
+
+    if (file_infos.isEmpty()) {
+        qDebug("No language files found.");
+        return 1;
+    }
+
+    qint64 total_nsecs(0);
+    qint64 build_nsecs(0);
+    qint64 bytes(0);
+    int blocks(0);
+    int strings(0);
+
+    for (int iter(0); iter < rounds; ++iter) {
+        Q_FOREACH (const QFileInfo &file_info, file_infos) {
+            QFile file(file_info.filePath());
+
+            if (not file.open(QIODevice::ReadOnly)) {
+                qWarning("Could not open %s", qPrintable(file_info.filePath()));
+                continue;
+            }
+
+            QElapsedTimer timer;
+            timer.start();
+
+            MaliitKeyboard::LayoutParser parser(&file);
+            const bool result(parser.parse());
+
+            total_nsecs += timer.nsecsElapsed();
+
+            if (not result) {
+                qWarning("Could not parse %s: %s", qPrintable(file_info.filePath()),
+                         qPrintable(parser.errorString()));
+            } else if (iter == 0) {
+                bytes += parser.arena()->bytesUsed();
+                blocks += parser.arena()->blockCount();
+                strings += parser.arena()->internedCount();
+            }
+
+            // Single keyboard, the way KeyboardLoader::keyboard() builds it:
+            file.seek(0);
+            timer.restart();
+
+            MaliitKeyboard::KeyboardBuilder builder(&file);
+            builder.build();
+
+            build_nsecs += timer.nsecsElapsed();
+        }
+    }
+
+    const int parses(rounds * file_infos.size());
+
+    qDebug("Parsed %d files %d times, average %f ms per file, total time %f ms",
+           file_infos.size(), rounds, total_nsecs / 1e6 / parses, total_nsecs / 1e6);
+    qDebug("Built first keyboard of each file, average %f ms per file",
+           build_nsecs / 1e6 / parses);
+    qDebug("Parse trees: %lld bytes of tags in %d arena blocks, %d distinct strings",
+           static_cast<long long>(bytes), blocks, strings);
+
+    return 0;
+}
+
+// The members of Key before styling moved into the KeyStyleTable, in their
+// former order, so that the compiler lays them out (and pads them) like it
+// did for the former key.
+struct FormerKey
+{
+    QPoint origin;
+    MaliitKeyboard::Area area;
+    MaliitKeyboard::Label label;
+    MaliitKeyboard::Key::Action action;
+    MaliitKeyboard::Key::Style style;
+    QMargins margins;
+    QByteArray icon;
+    bool has_extended_keys: 1;
+    unsigned int state: 2;
+    int flags_padding: 5;
+    QString command_sequence;
+};
+
+// Converts the main key area of every language and reports how much memory
+// its keys take, compared to keys holding Area, Label and icon by value.
+int benchmarkKeyMemory()
+{
+    MaliitKeyboard::KeyboardLoader loader;
+    const QStringList ids(loader.ids());
+
+    if (ids.isEmpty()) {
+        qDebug("No language files found.");
+        return 1;
+    }
+
+    MaliitKeyboard::Style style;
+    style.setProfile(style.availableProfiles().value(0));
+
+    const qint64 former_key_size(sizeof(FormerKey));
+    qint64 total_compact(0);
+    qint64 total_former(0);
+
+    Q_FOREACH (const QString &id, ids) {
+        loader.setActiveId(id);
+
+        MaliitKeyboard::Logic::KeyAreaConverter converter(style.attributes(), &loader);
+        const QVector<MaliitKeyboard::Key> keys(converter.keyArea().keys());
+        qint64 text_bytes(0);
+
+        Q_FOREACH (const MaliitKeyboard::Key &key, keys) {
+            text_bytes += (key.label().text().size() + key.commandSequence().size()) * sizeof(QChar);
+        }
+
+        const qint64 compact(keys.size() * sizeof(MaliitKeyboard::Key) + text_bytes);
+        const qint64 former(keys.size() * former_key_size + text_bytes);
+
+        qDebug("%s: %d keys, %lld bytes (was %lld bytes)", qPrintable(id), keys.size(),
+               static_cast<long long>(compact), static_cast<long long>(former));
+        total_compact += compact;
+        total_former += former;
+    }
+
+    qDebug("All layouts: %lld bytes (was %lld bytes), plus %lld bytes of shared key styles",
+           static_cast<long long>(total_compact), static_cast<long long>(total_former),
+           static_cast<long long>(MaliitKeyboard::KeyStyleTable::bytesUsed()));
+
+    return 0;
+}
+
+// Whether pressing the key shows another key area (or hides the keyboard),
+// after which the key area under test would be stale.
+bool changesKeyArea(const MaliitKeyboard::Key &key)
+{
+    switch (key.action()) {
+    case MaliitKeyboard::Key::ActionShift:
+    case MaliitKeyboard::Key::ActionSym:
+    case MaliitKeyboard::Key::ActionSwitch:
+    case MaliitKeyboard::Key::ActionDead:
+    case MaliitKeyboard::Key::ActionLayoutMenu:
+    case MaliitKeyboard::Key::ActionLeftLayout:
+    case MaliitKeyboard::Key::ActionRightLayout:
+    case MaliitKeyboard::Key::ActionClose:
+    case MaliitKeyboard::Key::ActionCancel:
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+// Shows the main key area of every language and reports what a touch event
+// costs: finding the touched key, linearly and through the key hit index,
+// and dispatching a press and release to the event handler. Keys switching
+// to another key area are not dispatched, so all events hit the same keys.
+int benchmarkTouch(int rounds)
+{
+    MaliitKeyboard::Logic::LayoutHelper helper;
+    MaliitKeyboard::Logic::LayoutUpdater updater;
+    const QStringList ids(updater.keyboardIds());
+
+    if (ids.isEmpty()) {
+        qDebug("No language files found.");
+        return 1;
+    }
+
+    MaliitKeyboard::SharedStyle style(new MaliitKeyboard::Style);
+    style->setProfile(style->availableProfiles().value(0));
+    updater.setLayout(&helper);
+    updater.setStyle(style);
+
+    MaliitKeyboard::Model::Layout model;
+    MaliitKeyboard::Logic::EventHandler event_handler(&model, &updater);
+
+    qint64 linear_nsecs(0);
+    qint64 index_nsecs(0);
+    qint64 dispatch_nsecs(0);
+    qint64 events(0);
+    qint64 dispatched_events(0);
+
+    std::srand(0);
+
+    Q_FOREACH (const QString &id, ids) {
+        updater.setActiveKeyboardId(id);
+        model.setKeyArea(helper.activeKeyArea());
+
+        const MaliitKeyboard::KeyArea key_area(model.keyArea());
+        const QVector<MaliitKeyboard::Key> keys(key_area.keys());
+        const QRect geometry(QPoint(), key_area.rect().size());
+
+        if (keys.isEmpty() || geometry.isEmpty()) {
+            continue;
+        }
+
+        QVector<QPoint> positions;
+        positions.reserve(rounds);
+
+        for (int iter(0); iter < rounds; ++iter) {
+            positions.append(QPoint(std::rand() % geometry.width(),
+                                    std::rand() % geometry.height()));
+        }
+
+        QElapsedTimer timer;
+        timer.start();
+
+        Q_FOREACH (const QPoint &pos, positions) {
+            MaliitKeyboard::Logic::keyHit(keys, geometry, pos);
+        }
+
+        linear_nsecs += timer.nsecsElapsed();
+        timer.restart();
+
+        Q_FOREACH (const QPoint &pos, positions) {
+            model.keyIndexAt(pos);
+        }
+
+        index_nsecs += timer.nsecsElapsed();
+
+        QVector<int> dispatched;
+        dispatched.reserve(rounds);
+
+        Q_FOREACH (const QPoint &pos, positions) {
+            const int index(model.keyIndexAt(pos));
+
+            if (index >= 0 && not changesKeyArea(keys.at(index))) {
+                dispatched.append(index);
+            }
+        }
+
+        timer.restart();
+
+        Q_FOREACH (int index, dispatched) {
+            event_handler.onPressed(index);
+            event_handler.onReleased(index);
+        }
+
+        dispatch_nsecs += timer.nsecsElapsed();
+        events += positions.size();
+        dispatched_events += dispatched.size();
+    }
+
+    if (events == 0) {
+        qDebug("No keys found.");
+        return 1;
+    }
+
+    qDebug("%lld touch events on %d layouts", static_cast<long long>(events), ids.size());
+    qDebug("Linear hit test: average %f us per event", linear_nsecs / 1e3 / events);
+    qDebug("Key hit index: average %f us per event", index_nsecs / 1e3 / events);
+    qDebug("Press and release: average %f us per event, %lld events dispatched",
+           dispatch_nsecs / 1e3 / qMax<qint64>(1, dispatched_events),
+           static_cast<long long>(dispatched_events));
+
+    return 0;
+}
+
+} // unnamed namespace
+
+// Usage:
+//   maliit-keyboard-benchmark [deadline [continuous]]
+//   maliit-keyboard-benchmark parse [rounds]
+//   maliit-keyboard-benchmark memory
+//   maliit-keyboard-benchmark touch [rounds]
 int main(int argc,
          char ** argv)
 {
     QCoreApplication app(argc, argv);
+
+    if (argc > 1 && qstrcmp(argv[1], "parse") == 0) {
+        return benchmarkParsing(argc > 2 ? qMax(1, std::atoi(argv[2])) : 100);
+    }
+
+    if (argc > 1 && qstrcmp(argv[1], "memory") == 0) {
+        return benchmarkKeyMemory();
+    }
+
+    if (argc > 1 && qstrcmp(argv[1], "touch") == 0) {
+        return benchmarkTouch(argc > 2 ? qMax(1, std::atoi(argv[2])) : 1000);
+    }
+
     double deadline(0);
 
     if (argc > 1) {
@@ -11,6 +11,67 @@ languages.files += languages/debug/showcase.xml
 styles.path = $$MALIIT_KEYBOARD_DATA_DIR
 styles.files = styles
 
+# Layouts are precompiled, and style images packed into atlases, by tools
+# that run at build time. Target binaries cannot run on the build host, so
+# when cross-compiling, host builds of the tools have to be passed as
+# LAYOUT_COMPILER and ATLAS_COMPILER; otherwise that step is skipped. The
+# plugin falls back to the XML layouts and the single images then.
+!disable-precompiled-data {
+    cross_compile {
+        !isEmpty(LAYOUT_COMPILER): CONFIG += precompile-layouts
+        !isEmpty(ATLAS_COMPILER): CONFIG += precompile-atlases
+    } else {
+        isEmpty(LAYOUT_COMPILER): LAYOUT_COMPILER = $${OUT_PWD}/../layoutcompiler/maliit-keyboard-layout-compiler
+        isEmpty(ATLAS_COMPILER): ATLAS_COMPILER = $${OUT_PWD}/../atlascompiler/maliit-keyboard-atlas-compiler
+        CONFIG += precompile-layouts precompile-atlases
+    }
+}
+
+# Layouts are also compiled to a binary format, which saves the XML parsing
+# when loading a layout. The XML files stay the reference; the loader falls
+# back to them if a compiled layout is missing or out of date.
+precompile-layouts {
+    LAYOUT_SOURCES = $$files($$PWD/languages/*.xml)
+
+    compiled_layouts.input = LAYOUT_SOURCES
+    compiled_layouts.output = $${OUT_PWD}/languages/${QMAKE_FILE_BASE}.lbin
+    compiled_layouts.commands = $$LAYOUT_COMPILER ${QMAKE_FILE_IN} ${QMAKE_FILE_OUT}
+    compiled_layouts.depends = $$LAYOUT_COMPILER
+    compiled_layouts.CONFIG = no_link target_predeps
+    QMAKE_EXTRA_COMPILERS += compiled_layouts
+
+    compiled_languages.path = $$MALIIT_PLUGINS_DATA_DIR/languages
+    compiled_languages.CONFIG += no_check_exist
+    for(source, LAYOUT_SOURCES) {
+        source_name = $$basename(source)
+        compiled_languages.files += $${OUT_PWD}/languages/$$replace(source_name, \\.xml$, .lbin)
+    }
+
+    INSTALLS += compiled_languages
+}
+
+# Style images are also packed into one atlas per profile, so that a whole
+# keyboard can be drawn from one texture. The single images stay the
+# reference; the plugin packs them at runtime if a profile has no atlas.
+precompile-atlases {
+    for(style_dir, $$list($$files($$PWD/styles/*))) {
+        profile = $$basename(style_dir)
+        atlas = atlas_$$replace(profile, -, _)
+        atlas_dir = $${OUT_PWD}/styles/$${profile}/images
+
+        eval($${atlas}.target = $${atlas_dir}/atlas.png)
+        eval($${atlas}.commands = $$ATLAS_COMPILER $${style_dir}/images $${atlas_dir})
+        eval($${atlas}.depends = $$ATLAS_COMPILER $$files($${style_dir}/images/*.png))
+        QMAKE_EXTRA_TARGETS += $${atlas}
+        PRE_TARGETDEPS += $${atlas_dir}/atlas.png
+
+        eval($${atlas}_install.path = $$MALIIT_KEYBOARD_DATA_DIR/styles/$${profile}/images)
+        eval($${atlas}_install.files = $${atlas_dir}/atlas.png $${atlas_dir}/atlas.ini)
+        eval($${atlas}_install.CONFIG += no_check_exist)
+        INSTALLS += $${atlas}_install
+    }
+}
+
 INSTALLS += languages styles
 
 QMAKE_EXTRA_TARGETS += check
@@ -0,0 +1,13 @@
+include(../config.pri)
+
+TOP_BUILDDIR = $${OUT_PWD}/../..
+TEMPLATE = app
+TARGET = maliit-keyboard-layout-compiler
+
+INCLUDEPATH += ../lib
+LIBS += $${TOP_BUILDDIR}/$${MALIIT_KEYBOARD_LIB}
+PRE_TARGETDEPS += $${TOP_BUILDDIR}/$${MALIIT_KEYBOARD_LIB}
+SOURCES += main.cpp
+
+# Only used at build time, see data/data.pro; not installed.
+QT = core
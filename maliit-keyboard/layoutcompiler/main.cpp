@@ -0,0 +1,85 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012 Openismus GmbH. All rights reserved.
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "parser/layoutparser.h"
+#include "parser/layoutblob.h"
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QSaveFile>
+#include <QStringList>
+
+// Compiles a language layout XML file into the binary format read by
+// KeyboardLoader, see LayoutBlobWriter.
+int main(int argc,
+         char ** argv)
+{
+    QCoreApplication app(argc, argv);
+    const QStringList arguments(app.arguments());
+
+    if (arguments.size() != 3) {
+        qWarning("Usage: %s <layout.xml> <output%s>",
+                 qPrintable(arguments.first()), MaliitKeyboard::CompiledLayoutSuffix);
+        return 1;
+    }
+
+    const QString input_path(arguments.at(1));
+    const QString output_path(arguments.at(2));
+    QFile input(input_path);
+
+    if (not input.open(QIODevice::ReadOnly)) {
+        qWarning("Could not open %s: %s", qPrintable(input_path), qPrintable(input.errorString()));
+        return 1;
+    }
+
+    MaliitKeyboard::LayoutParser parser(&input);
+
+    if (not parser.parse()) {
+        qWarning("Could not parse %s: %s", qPrintable(input_path), qPrintable(parser.errorString()));
+        return 1;
+    }
+
+    QSaveFile output(output_path);
+
+    if (not output.open(QIODevice::WriteOnly)) {
+        qWarning("Could not open %s: %s", qPrintable(output_path), qPrintable(output.errorString()));
+        return 1;
+    }
+
+    MaliitKeyboard::LayoutBlobWriter writer(&output);
+
+    if (not writer.write(parser, input.size()) || not output.commit()) {
+        qWarning("Could not write %s: %s", qPrintable(output_path), qPrintable(writer.errorString()));
+        return 1;
+    }
+
+    return 0;
+}
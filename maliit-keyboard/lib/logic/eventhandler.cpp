@@ -83,16 +83,16 @@ void EventHandler::onEntered(int index)
 {
     Q_D(EventHandler);
 
-    const QVector<Key> &keys(d->layout->keyArea().keys());
+    const int key_count(d->layout->rowCount());
 
-    if (index >= keys.count()) {
+    if (index >= key_count) {
         qWarning() << __PRETTY_FUNCTION__
                    << "Invalid index:" << index
-                   << "Keys available:" << keys.count();
+                   << "Keys available:" << key_count;
         return;
     }
 
-    const Key &key(keys.at(index));
+    const Key key(d->layout->key(index));
 
     const Key pressed_key(d->updater->modifyKey(key, KeyDescription::PressedState));
     d->layout->replaceKey(index, pressed_key);
@@ -106,16 +106,16 @@ void EventHandler::onExited(int index)
 {
     Q_D(EventHandler);
 
-    const QVector<Key> &keys(d->layout->keyArea().keys());
+    const int key_count(d->layout->rowCount());
 
-    if (index >= keys.count()) {
+    if (index >= key_count) {
         qWarning() << __PRETTY_FUNCTION__
                    << "Invalid index:" << index
-                   << "Keys available:" << keys.count();
+                   << "Keys available:" << key_count;
         return;
     }
 
-    const Key &key(keys.at(index));
+    const Key key(d->layout->key(index));
 
     const Key normal_key(d->updater->modifyKey(key, KeyDescription::NormalState));
     d->layout->replaceKey(index, normal_key);
@@ -129,16 +129,16 @@ void EventHandler::onPressed(int index)
 {
     Q_D(EventHandler);
 
-    const QVector<Key> &keys(d->layout->keyArea().keys());
+    const int key_count(d->layout->rowCount());
 
-    if (index >= keys.count()) {
+    if (index >= key_count) {
         qWarning() << __PRETTY_FUNCTION__
                    << "Invalid index:" << index
-                   << "Keys available:" << keys.count();
+                   << "Keys available:" << key_count;
         return;
     }
 
-    const Key &key(keys.at(index));
+    const Key key(d->layout->key(index));
 
     const Key pressed_key(d->updater->modifyKey(key, KeyDescription::PressedState));
     d->layout->replaceKey(index, pressed_key);
@@ -152,16 +152,16 @@ void EventHandler::onReleased(int index)
 {
     Q_D(EventHandler);
 
-    const QVector<Key> &keys(d->layout->keyArea().keys());
+    const int key_count(d->layout->rowCount());
 
-    if (index >= keys.count()) {
+    if (index >= key_count) {
         qWarning() << __PRETTY_FUNCTION__
                    << "Invalid index:" << index
-                   << "Keys available:" << keys.count();
+                   << "Keys available:" << key_count;
         return;
     }
 
-    const Key &key(keys.at(index));
+    const Key key(d->layout->key(index));
 
     const Key normal_key(d->updater->modifyKey(key, KeyDescription::NormalState));
     d->layout->replaceKey(index, normal_key);
@@ -175,16 +175,16 @@ void EventHandler::onPressAndHold(int index)
 {
     Q_D(EventHandler);
 
-    const QVector<Key> &keys(d->layout->keyArea().keys());
+    const int key_count(d->layout->rowCount());
 
-    if (index >= keys.count()) {
+    if (index >= key_count) {
         qWarning() << __PRETTY_FUNCTION__
                    << "Invalid index:" << index
-                   << "Keys available:" << keys.count();
+                   << "Keys available:" << key_count;
         return;
     }
 
-    const Key &key(keys.at(index));
+    const Key key(d->layout->key(index));
 
     // FIXME: long-press on space needs to work again to save words to dictionary!
     if (key.hasExtendedKeys()) {
@@ -55,6 +55,26 @@ T findFilteredElement(const QVector<T> &filtered,
     return T();
 }
 
+//! Whether both elements are the same. Keys are compared by their identifier
+//! if they have one.
+template<class T>
+bool isSameElement(const T &lhs,
+                   const T &rhs)
+{
+    return (lhs == rhs);
+}
+
+template<>
+bool isSameElement<Key>(const Key &lhs,
+                        const Key &rhs)
+{
+    if (lhs.id() != 0 && rhs.id() != 0) {
+        return (lhs.id() == rhs.id());
+    }
+
+    return (lhs == rhs);
+}
+
 //! From a list of elements of type T, find out whether pos (in same coordinate
 //! system as geometry) hits one of the elements, if their bounding box is
 //! translated to geometry's top left corner.
@@ -78,22 +98,21 @@ T elementHit(const QVector<T> &elements,
     // TODO: assume pos in screen coordinates and translate here?
     if (geometry.contains(pos)) {
         const QPoint &origin(geometry.topLeft());
+        const T &from_filter = findFilteredElement<T>(filtered, origin, pos);
 
         // FIXME: use binary range search
         Q_FOREACH (const T &current, elements) {
-            const T &from_filter = findFilteredElement<T>(filtered, origin, pos);
-
             if (current.rect().translated(origin).contains(pos)) {
                 switch (behaviour) {
                 case IgnoreIfInFilter:
-                    if (current != from_filter) {
+                    if (not isSameElement<T>(current, from_filter)) {
                         return current;
                     }
 
                     break;
 
                 case AcceptIfInFilter:
-                    if (current == from_filter) {
+                    if (isSameElement<T>(current, from_filter)) {
                         return current;
                     }
 
@@ -51,15 +51,32 @@ namespace Logic {
 //! the valid combinations.
 
 namespace {
+//! Sections key identifiers are made of, see Key::idFromPosition(). The
+//! shifted and dead key variants of the main key area show the same keys,
+//! so they share its section.
+enum KeyAreaSection {
+    MainSection,
+    PreviousSection,
+    NextSection,
+    ExtendedSection,
+    NumberSection,
+    PhoneNumberSection,
+    SymbolsSection // First symbols page, the others follow.
+};
+
 //! \brief Creates a key area from a keyboard.
 //! \param attributes The styling attributes that get applied to the key area.
 //! \param source The keyboard layout used for the key area.
 //! \param orientation The layout orientation.
+//! \param layout_id The id of the active layout.
+//! \param section The section used for the key identifiers.
 //! \param is_extended_keyarea Whether the resulting key area is used for
 //!        extended keys (optional).
 KeyArea createFromKeyboard(StyleAttributes *attributes,
                            const Keyboard &source,
                            LayoutHelper::Orientation orientation,
+                           const QString &layout_id,
+                           int section,
                            bool is_extended_keyarea = false)
 {
     // An ad-hoc geometry updater that also uses styling information.
@@ -101,6 +118,7 @@ KeyArea createFromKeyboard(StyleAttributes *attributes,
         row_indices.append(index);
         Key &key(kb.keys[index]);
         const KeyDescription &desc(kb.key_descriptions.at(index));
+        key.setId(Key::idFromPosition(section, index));
 
         qreal row_height = 0;
         if (desc.row == 0 && key_top_row_height > 0.0) {
@@ -206,6 +224,7 @@ KeyArea createFromKeyboard(StyleAttributes *attributes,
     ka.setOrigin(is_extended_keyarea ? QPoint(0, -attributes->verticalOffset(orientation))
                                      : QPoint(0, attributes->wordRibbonHeight(orientation)));
     ka.setKeys(kb.keys);
+    ka.setId(layout_id + "/" + QString::number(section));
 
     return ka;
 }
@@ -241,28 +260,32 @@ void KeyAreaConverter::setLayoutOrientation(LayoutHelper::Orientation orientatio
 //! \brief Returns the main key area.
 KeyArea KeyAreaConverter::keyArea() const
 {
-    return createFromKeyboard(m_attributes, m_loader->keyboard(), m_orientation);
+    return createFromKeyboard(m_attributes, m_loader->keyboard(), m_orientation,
+                              m_loader->activeId(), MainSection);
 }
 
 
 //! \brief Returns the next key area (right of main key area).
 KeyArea KeyAreaConverter::nextKeyArea() const
 {
-    return createFromKeyboard(m_attributes, m_loader->nextKeyboard(), m_orientation);
+    return createFromKeyboard(m_attributes, m_loader->nextKeyboard(), m_orientation,
+                              m_loader->activeId(), NextSection);
 }
 
 
 //! \brief Returns the previous key area (left of main key area).
 KeyArea KeyAreaConverter::previousKeyArea() const
 {
-    return createFromKeyboard(m_attributes, m_loader->previousKeyboard(), m_orientation);
+    return createFromKeyboard(m_attributes, m_loader->previousKeyboard(), m_orientation,
+                              m_loader->activeId(), PreviousSection);
 }
 
 
 //! \brief Returns the main key area with shift bindings activated.
 KeyArea KeyAreaConverter::shiftedKeyArea() const
 {
-    return createFromKeyboard(m_attributes, m_loader->shiftedKeyboard(), m_orientation);
+    return createFromKeyboard(m_attributes, m_loader->shiftedKeyboard(), m_orientation,
+                              m_loader->activeId(), MainSection);
 }
 
 
@@ -270,7 +293,8 @@ KeyArea KeyAreaConverter::shiftedKeyArea() const
 //! \param page The symbols page to return (optional).
 KeyArea KeyAreaConverter::symbolsKeyArea(int page) const
 {
-    return createFromKeyboard(m_attributes, m_loader->symbolsKeyboard(page), m_orientation);
+    return createFromKeyboard(m_attributes, m_loader->symbolsKeyboard(page), m_orientation,
+                              m_loader->activeId(), SymbolsSection + qMax(0, page));
 }
 
 
@@ -278,7 +302,8 @@ KeyArea KeyAreaConverter::symbolsKeyArea(int page) const
 //! \param dead The key used to look up the dead keys.
 KeyArea KeyAreaConverter::deadKeyArea(const Key &dead) const
 {
-    return createFromKeyboard(m_attributes, m_loader->deadKeyboard(dead), m_orientation);
+    return createFromKeyboard(m_attributes, m_loader->deadKeyboard(dead), m_orientation,
+                              m_loader->activeId(), MainSection);
 }
 
 
@@ -286,7 +311,8 @@ KeyArea KeyAreaConverter::deadKeyArea(const Key &dead) const
 //! \param dead The key used to look up the dead keys.
 KeyArea KeyAreaConverter::shiftedDeadKeyArea(const Key &dead) const
 {
-    return createFromKeyboard(m_attributes, m_loader->shiftedDeadKeyboard(dead), m_orientation);
+    return createFromKeyboard(m_attributes, m_loader->shiftedDeadKeyboard(dead), m_orientation,
+                              m_loader->activeId(), MainSection);
 }
 
 
@@ -294,21 +320,24 @@ KeyArea KeyAreaConverter::shiftedDeadKeyArea(const Key &dead) const
 //! \param key The key used to look up the extended key binding.
 KeyArea KeyAreaConverter::extendedKeyArea(const Key &key) const
 {
-    return createFromKeyboard(m_attributes, m_loader->extendedKeyboard(key), m_orientation, true);
+    return createFromKeyboard(m_attributes, m_loader->extendedKeyboard(key), m_orientation,
+                              m_loader->activeId(), ExtendedSection, true);
 }
 
 
 //! Returns the number key area.
 KeyArea KeyAreaConverter::numberKeyArea() const
 {
-    return createFromKeyboard(m_attributes, m_loader->numberKeyboard(), m_orientation);
+    return createFromKeyboard(m_attributes, m_loader->numberKeyboard(), m_orientation,
+                              m_loader->activeId(), NumberSection);
 }
 
 
 //! Returns the phone number key area.
 KeyArea KeyAreaConverter::phoneNumberKeyArea() const
 {
-    return createFromKeyboard(m_attributes, m_loader->phoneNumberKeyboard(), m_orientation);
+    return createFromKeyboard(m_attributes, m_loader->phoneNumberKeyboard(), m_orientation,
+                              m_loader->activeId(), PhoneNumberSection);
 }
 
 }} // namespace Logic, MaliitKeyboard
@@ -0,0 +1,385 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012 Openismus GmbH. All rights reserved.
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "keyboardbuilder.h"
+
+namespace MaliitKeyboard {
+
+//! \class KeyboardBuilder
+//! Builds the Keyboard for one section and shift state of a layout file in
+//! a single pass over the XML, without creating the tag tree LayoutParser
+//! creates. Sections, modifiers and extended keys which are not needed are
+//! skipped, and attributes are only copied if they end up in the keyboard.
+//!
+//! Reading stops after the requested section, so the builder does not
+//! validate layout files; LayoutParser does, e.g. during LayoutWarmUp. The
+//! keyboards the builder builds are the same as KeyboardLoader builds from
+//! the tag tree of a valid file.
+
+namespace {
+
+// These have to match the values LayoutParser accepts.
+const char *const StyleValues[] = {
+    "normal", "special", "deadkey", "digits", "activated"
+};
+const char *const WidthValues[] = {
+    "xx-small", "x-small", "small", "medium", "large", "x-large", "xx-large", "stretched"
+};
+const char *const ActionValues[] = {
+    "insert", "shift", "backspace", "space", "cycle", "layout-menu", "sym", "return", "commit",
+    "decimal_separator", "plus_minus_toggle", "switch", "on_off_toggle", "compose",
+    "left", "up", "right", "down", "close", "cancel", "tab", "dead", "left-layout", "right-layout",
+    "command"
+};
+
+} // unnamed namespace
+
+KeyboardBuilder::KeyboardBuilder(QIODevice *device)
+    : m_device(device)
+    , m_xml()
+    , m_keyboard()
+    , m_shifted(false)
+    , m_dead_key()
+    , m_section_count(0)
+{}
+
+
+//! \brief Builds the keyboard from the (opened) device.
+//! \param shifted Whether to use the shift modifier bindings.
+//! \param page The section to build, wrapping around like in KeyboardLoader.
+//! \param dead_label If a single character, the accent to apply.
+//! \returns Whether the keyboard could be built.
+bool KeyboardBuilder::build(bool shifted,
+                            int page,
+                            const QString &dead_label)
+{
+    m_shifted = shifted;
+    m_dead_key = (dead_label.size() == 1) ? dead_label.at(0) : QChar::Null;
+
+    if (not buildPage(page)) {
+        return false;
+    }
+
+    // The page is past the last section, but we only know how many there are
+    // after reading them all once.
+    if (page >= m_section_count && m_section_count > 0) {
+        if (not m_device->seek(0)) {
+            return false;
+        }
+
+        return buildPage(page % m_section_count);
+    }
+
+    return true;
+}
+
+
+//! \brief Returns the built keyboard.
+const Keyboard KeyboardBuilder::keyboard() const
+{
+    return m_keyboard;
+}
+
+
+const QString KeyboardBuilder::errorString() const
+{
+    return m_xml.errorString();
+}
+
+
+//! \brief Returns the icon used for a key with given action.
+KeyDescription::Icon KeyboardBuilder::iconForAction(Key::Action action,
+                                                    bool has_custom_icon)
+{
+    switch (action) {
+    case Key::ActionLeft:
+        return KeyDescription::LeftIcon;
+    case Key::ActionRight:
+        return KeyDescription::RightIcon;
+    case Key::ActionUp:
+        return KeyDescription::UpIcon;
+    case Key::ActionDown:
+        return KeyDescription::DownIcon;
+    case Key::ActionBackspace:
+        return KeyDescription::BackspaceIcon;
+    case Key::ActionReturn:
+        return KeyDescription::ReturnIcon;
+    case Key::ActionShift:
+        return KeyDescription::ShiftIcon;
+    case Key::ActionClose:
+        return KeyDescription::CloseIcon;
+    case Key::ActionCancel:
+        return KeyDescription::CancelIcon;
+    case Key::ActionLayoutMenu:
+        return KeyDescription::LayoutMenuIcon;
+    case Key::ActionLeftLayout:
+        return KeyDescription::LeftLayoutIcon;
+    case Key::ActionRightLayout:
+        return KeyDescription::RightLayoutIcon;
+    default:
+        return (has_custom_icon ? KeyDescription::CustomIcon : KeyDescription::NoIcon);
+    }
+}
+
+
+bool KeyboardBuilder::buildPage(int page)
+{
+    m_keyboard = Keyboard();
+    m_section_count = 0;
+    m_xml.clear();
+    m_xml.setDevice(m_device);
+
+    if (m_xml.readNextStartElement()) {
+        if (m_xml.name() != QLatin1String("keyboard")) {
+            m_xml.raiseError(QString::fromLatin1("Expected '<keyboard>', but got '<%1>'.").arg(m_xml.name().toString()));
+        }
+
+        while (not m_xml.hasError() && m_xml.readNextStartElement()) {
+            if (m_xml.name() == QLatin1String("layout")) {
+                // Only the first layout is used.
+                readLayout(page);
+                break;
+            }
+
+            m_xml.skipCurrentElement();
+        }
+    }
+
+    return not m_xml.hasError();
+}
+
+
+void KeyboardBuilder::readLayout(int page)
+{
+    while (m_xml.readNextStartElement()) {
+        if (m_xml.name() != QLatin1String("section")) {
+            m_xml.skipCurrentElement();
+            continue;
+        }
+
+        if (m_section_count++ == page) {
+            readSection();
+            return;
+        }
+
+        m_xml.skipCurrentElement();
+    }
+}
+
+
+void KeyboardBuilder::readSection()
+{
+    QString style(m_xml.attributes().value(QLatin1String("style")).toString());
+    int row(0);
+    int key_count(0);
+
+    while (m_xml.readNextStartElement()) {
+        if (m_xml.name() == QLatin1String("row")) {
+            key_count += readRow(row);
+            ++row;
+        } else {
+            m_xml.skipCurrentElement();
+        }
+    }
+
+    if (style.isEmpty()) {
+        style = "keys" + QString::number(key_count);
+    }
+
+    m_keyboard.style_name = style;
+}
+
+
+int KeyboardBuilder::readRow(int row)
+{
+    bool spacer_met(false);
+    int key_count(0);
+
+    while (m_xml.readNextStartElement()) {
+        const QStringRef name(m_xml.name());
+
+        if (name == QLatin1String("key")) {
+            readKey(row, spacer_met);
+            spacer_met = false;
+            ++key_count;
+        } else {
+            if (name == QLatin1String("spacer")) {
+                if (not m_keyboard.key_descriptions.isEmpty()) {
+                    KeyDescription &previous_description(m_keyboard.key_descriptions.last());
+
+                    if (previous_description.row == row) {
+                        previous_description.right_spacer = true;
+                    }
+                }
+                spacer_met = true;
+            }
+            m_xml.skipCurrentElement();
+        }
+    }
+
+    return key_count;
+}
+
+
+void KeyboardBuilder::readKey(int row,
+                              bool spacer_met)
+{
+    const QXmlStreamAttributes attributes(m_xml.attributes());
+    const int style(enumValue(attributes.value(QLatin1String("style")), StyleValues,
+                              sizeof(StyleValues) / sizeof(StyleValues[0]), Key::StyleNormalKey));
+    const int width(enumValue(attributes.value(QLatin1String("width")), WidthValues,
+                              sizeof(WidthValues) / sizeof(WidthValues[0]), KeyDescription::Medium));
+    const bool rtl(boolValue(attributes.value(QLatin1String("rtl")), false));
+    Binding binding;
+    bool extended(false);
+
+    binding.action = Key::ActionInsert;
+
+    while (m_xml.readNextStartElement()) {
+        const QStringRef name(m_xml.name());
+
+        if (name == QLatin1String("binding")) {
+            readBinding(&binding, true);
+        } else {
+            extended = extended || (name == QLatin1String("extended"));
+            m_xml.skipCurrentElement();
+        }
+    }
+
+    Key key;
+    KeyDescription description;
+
+    key.setExtendedKeysEnabled(extended);
+    key.rLabel().setText(binding.label);
+    key.setAction(binding.action);
+    key.setCommandSequence(binding.sequence);
+    key.setIcon(binding.icon.toUtf8());
+    key.setStyle(static_cast<Key::Style>(style));
+
+    description.row = row;
+    description.use_rtl_icon = rtl;
+    description.left_spacer = spacer_met;
+    description.right_spacer = false;
+    description.width = static_cast<KeyDescription::Width>(width);
+    description.icon = iconForAction(binding.action, not binding.icon.isEmpty());
+    description.font_group = KeyDescription::NormalFontGroup;
+
+    m_keyboard.keys.append(key);
+    m_keyboard.key_descriptions.append(description);
+}
+
+
+void KeyboardBuilder::readBinding(Binding *binding,
+                                  bool read_modifiers)
+{
+    const QXmlStreamAttributes attributes(m_xml.attributes());
+    const bool dead(boolValue(attributes.value(QLatin1String("dead")), false));
+    const QStringRef label(attributes.value(QLatin1String("label")));
+    int accent_index(-1);
+    QStringRef accented_labels;
+
+    if (not m_dead_key.isNull()) {
+        accent_index = attributes.value(QLatin1String("accents")).indexOf(m_dead_key);
+        accented_labels = attributes.value(QLatin1String("accented_labels"));
+    }
+
+    binding->action = (dead ? Key::ActionDead
+                            : static_cast<Key::Action>(enumValue(attributes.value(QLatin1String("action")), ActionValues,
+                                                                 sizeof(ActionValues) / sizeof(ActionValues[0]),
+                                                                 Key::ActionInsert)));
+    binding->label = ((accent_index < 0 || accent_index >= accented_labels.size())
+                      ? label.toString() : QString(accented_labels.at(accent_index)));
+    binding->sequence = attributes.value(QLatin1String("sequence")).toString();
+    binding->icon = attributes.value(QLatin1String("icon")).toString();
+
+    while (m_xml.readNextStartElement()) {
+        if (read_modifiers && m_shifted && m_xml.name() == QLatin1String("modifiers")) {
+            const QXmlStreamAttributes modifiers_attributes(m_xml.attributes());
+            const QStringRef keys(modifiers_attributes.value(QLatin1String("keys")));
+
+            // Like in LayoutParser, modifiers without keys are shift modifiers.
+            if (keys.isEmpty() || keys == QLatin1String("shift")) {
+                while (m_xml.readNextStartElement()) {
+                    if (m_xml.name() == QLatin1String("binding")) {
+                        readBinding(binding, false);
+                    } else {
+                        m_xml.skipCurrentElement();
+                    }
+                }
+                continue;
+            }
+        }
+
+        m_xml.skipCurrentElement();
+    }
+}
+
+
+bool KeyboardBuilder::boolValue(const QStringRef &value,
+                                bool default_value)
+{
+    if (value.isEmpty()) {
+        return default_value;
+    }
+
+    if (value == QLatin1String("true") || value == QLatin1String("1")) {
+        return true;
+    }
+
+    if (value == QLatin1String("false") || value == QLatin1String("0")) {
+        return false;
+    }
+
+    m_xml.raiseError(QString::fromLatin1("Expected 'true', 'false', '1' or '0', but got '%1'.").arg(value.toString()));
+    return default_value;
+}
+
+
+int KeyboardBuilder::enumValue(const QStringRef &value,
+                               const char *const values[],
+                               int count,
+                               int default_value)
+{
+    if (value.isEmpty()) {
+        return default_value;
+    }
+
+    for (int index = 0; index < count; ++index) {
+        if (value == QLatin1String(values[index])) {
+            return index;
+        }
+    }
+
+    m_xml.raiseError(QString::fromLatin1("Unexpected value '%1'.").arg(value.toString()));
+    return default_value;
+}
+
+} // namespace MaliitKeyboard
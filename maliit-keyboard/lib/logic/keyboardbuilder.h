@@ -0,0 +1,92 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012 Openismus GmbH. All rights reserved.
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef MALIIT_KEYBOARD_KEYBOARDBUILDER_H
+#define MALIIT_KEYBOARD_KEYBOARDBUILDER_H
+
+#include "models/keyboard.h"
+
+#include <QtCore>
+
+namespace MaliitKeyboard {
+
+class KeyboardBuilder
+{
+    Q_DISABLE_COPY(KeyboardBuilder)
+
+private:
+    struct Binding
+    {
+        Key::Action action;
+        QString label;
+        QString sequence;
+        QString icon;
+    };
+
+    QIODevice *const m_device;
+    QXmlStreamReader m_xml;
+    Keyboard m_keyboard;
+    bool m_shifted;
+    QChar m_dead_key;
+    int m_section_count;
+
+public:
+    explicit KeyboardBuilder(QIODevice *device);
+
+    bool build(bool shifted = false,
+               int page = 0,
+               const QString &dead_label = QString());
+    const Keyboard keyboard() const;
+    const QString errorString() const;
+
+    static KeyDescription::Icon iconForAction(Key::Action action,
+                                              bool has_custom_icon);
+
+private:
+    bool buildPage(int page);
+    void readLayout(int page);
+    void readSection();
+    int readRow(int row);
+    void readKey(int row,
+                 bool spacer_met);
+    void readBinding(Binding *binding,
+                     bool read_modifiers);
+    bool boolValue(const QStringRef &value,
+                   bool default_value);
+    int enumValue(const QStringRef &value,
+                  const char *const values[],
+                  int count,
+                  int default_value);
+};
+
+} // namespace MaliitKeyboard
+
+#endif // MALIIT_KEYBOARD_KEYBOARDBUILDER_H
@@ -33,12 +33,18 @@
 
 #include <QDir>
 #include <QFile>
-#include <QRegExp>
+#include <QFileInfo>
+#include <QTimer>
+#include <QThreadPool>
 
 #include "parser/layoutparser.h"
 #include "coreutils.h"
 
 #include "keyboardloader.h"
+#include "keyboardbuilder.h"
+#include "layoutcache.h"
+#include "languageindex.h"
+#include "keyboardvariantcache.h"
 
 namespace {
 
@@ -50,48 +56,44 @@ using namespace MaliitKeyboard;
 // and it sets its static variable once. We want to be able to set the
 // environment variable altering behaviour of pluginDataDirectory for testing
 // purposes.
+//
+// The languages directory is also read from prefetch threads, hence the
+// (thread-safe) static initialization instead of a lazily assigned string.
 QString getLanguagesDir()
 {
-    static QString languages_dir;
-
-    if (languages_dir.isEmpty()) {
-        // From http://doc.qt.nokia.com/4.7/qdir.html#separator: If you always
-        // use "/", Qt will translate your paths to conform to the underlying
-        // operating system.
-        languages_dir = CoreUtils::pluginDataDirectory() + "/languages";
-    }
+    // From http://doc.qt.nokia.com/4.7/qdir.html#separator: If you always
+    // use "/", Qt will translate your paths to conform to the underlying
+    // operating system.
+    static const QString languages_dir(CoreUtils::pluginDataDirectory() + "/languages");
 
     return languages_dir;
 }
 
-typedef const QStringList (LayoutParser::*ParserFunc)() const;
-
-TagKeyboardPtr getTagKeyboard(const QString &id)
+KeyboardVariantCache *sharedVariantCache()
 {
-    if (id.isEmpty()) {
-        return TagKeyboardPtr();
-    }
-
-    const QString path(getLanguagesDir() + "/" + id + ".xml");
-    QFile file(path);
+    static KeyboardVariantCache cache;
+    return &cache;
+}
 
-    if (file.exists()) {
-        file.open(QIODevice::ReadOnly);
+LayoutCache *sharedLayoutCache()
+{
+    // Keyboards built from a layout go stale with it:
+    static LayoutCache cache(getLanguagesDir(), LayoutCache::DefaultCapacity,
+                             sharedVariantCache());
+    return &cache;
+}
 
-        LayoutParser parser(&file);
-        const bool result(parser.parse());
+LanguageIndex *sharedLanguageIndex()
+{
+    static LanguageIndex index(getLanguagesDir());
+    return &index;
+}
 
-        file.close();
-        if (result) {
-            return parser.keyboard();
-        } else {
-            qWarning() << __PRETTY_FUNCTION__ << "Could not parse file:" << path << ", error:" << parser.errorString();
-        }
-    } else {
-        qWarning() << __PRETTY_FUNCTION__ << "File not found:" << path;
-    }
+TagKeyboardPtr getTagKeyboard(const QString &id)
+{
+    const SharedParsedLayout layout(sharedLayoutCache()->layout(id));
 
-    return TagKeyboardPtr();
+    return (layout ? layout->keyboard : TagKeyboardPtr());
 }
 
 QPair<Key, KeyDescription> keyAndDescFromTags(const TagKeyPtr &key,
@@ -121,52 +123,7 @@ QPair<Key, KeyDescription> keyAndDescFromTags(const TagKeyPtr &key,
     skey_description.right_spacer = false;
     skey_description.width = static_cast<KeyDescription::Width>(key->width());
 
-    switch (skey.action()) {
-    case Key::ActionLeft:
-        skey_description.icon = KeyDescription::LeftIcon;
-        break;
-    case Key::ActionRight:
-        skey_description.icon = KeyDescription::RightIcon;
-        break;
-    case Key::ActionUp:
-        skey_description.icon = KeyDescription::UpIcon;
-        break;
-    case Key::ActionDown:
-        skey_description.icon = KeyDescription::DownIcon;
-        break;
-    case Key::ActionBackspace:
-        skey_description.icon = KeyDescription::BackspaceIcon;
-        break;
-    case Key::ActionReturn:
-        skey_description.icon = KeyDescription::ReturnIcon;
-        break;
-    case Key::ActionShift:
-        skey_description.icon = KeyDescription::ShiftIcon;
-        break;
-    case Key::ActionClose:
-        skey_description.icon = KeyDescription::CloseIcon;
-        break;
-    case Key::ActionCancel:
-        skey_description.icon = KeyDescription::CancelIcon;
-        break;
-    case Key::ActionLayoutMenu:
-        skey_description.icon = KeyDescription::LayoutMenuIcon;
-        break;
-    case Key::ActionLeftLayout:
-        skey_description.icon = KeyDescription::LeftLayoutIcon;
-        break;
-    case Key::ActionRightLayout:
-        skey_description.icon = KeyDescription::RightLayoutIcon;
-        break;
-    default:
-        if (skey.icon().isEmpty()) {
-            skey_description.icon = KeyDescription::NoIcon;
-        } else {
-            skey_description.icon = KeyDescription::CustomIcon;
-        }
-        break;
-    }
-
+    skey_description.icon = KeyboardBuilder::iconForAction(skey.action(), not skey.icon().isEmpty());
     skey_description.font_group = KeyDescription::NormalFontGroup;
 
     return qMakePair(skey, skey_description);
@@ -251,128 +208,137 @@ Keyboard getKeyboard(const TagKeyboardPtr &keyboard,
     return skeyboard;
 }
 
-QPair<TagKeyPtr, TagBindingPtr> getTagKeyAndBinding(const TagKeyboardPtr &keyboard,
-                                                    const QString &label,
-                                                    bool *shifted)
+// Returns a keyboard variant of a layout, building it only if it is not
+// cached yet. A layout already parsed into the LayoutCache is reused, as is
+// an up to date compiled layout, which is read into the cache first.
+// Otherwise the keyboard is streamed straight from the layout file, which
+// is a lot cheaper than building the whole tag tree for a single keyboard.
+Keyboard getCachedKeyboard(const QString &id,
+                           bool shifted = false,
+                           int page = 0,
+                           const QString &dead_label = "")
 {
-    QPair<TagKeyPtr, TagBindingPtr> pair;
-
-    if (keyboard) {
-        TagLayoutPtrs layouts(keyboard->layouts());
+    if (id.isEmpty()) {
+        return Keyboard();
+    }
 
-        if (not layouts.isEmpty()) {
-            // sections cannot be empty - parser does not allow that.
-            TagRowPtrs rows(layouts.first()->sections().first()->rows());
+    const QString path(getLanguagesDir() + "/" + id + ".xml");
+    const QFileInfo file_info(path);
 
-            Q_FOREACH (const TagRowPtr &row, rows) {
-                TagRowElementPtrs elements(row->elements());
+    if (not file_info.exists()) {
+        qWarning() << __PRETTY_FUNCTION__ << "File not found:" << path;
+        return Keyboard();
+    }
 
-                Q_FOREACH (const TagRowElementPtr &element, elements) {
-                    if (element->element_type() == TagRowElement::Key) {
-                        TagKeyPtr key(element.staticCast<TagKey>());
-                        TagBindingPtr the_binding;
-                        TagBindingPtr binding(key->binding());
-
-                        // Hotfix for suppressing long-press on space bringing
-                        // up extended keys if another key has empty label, in
-                        // given layout.
-                        // FIXME: Make extended keyboard/keyarea part of key
-                        // model instead, to avoid wrong lookups.
-                        if (binding->action() == TagBinding::Space) {
-                            continue;
-                        }
-                        if (binding->label() == label) {
-                            the_binding = binding;
-                            *shifted = false;
-                        } else {
-                            const TagModifiersPtrs all_modifiers(binding->modifiers());
+    const QDateTime modified(file_info.lastModified());
+    const qint64 size(file_info.size());
+    // Normalize the dead label the way getKeyboard() interprets it, so that
+    // equal keyboards share one cache entry.
+    const KeyboardVariant variant(id, shifted, page,
+                                  (dead_label.size() == 1) ? dead_label : QString());
+    Keyboard skeyboard;
 
-                            Q_FOREACH (const TagModifiersPtr &modifiers, all_modifiers) {
-                                const TagBindingPtr mod_binding(modifiers->binding());
+    if (sharedVariantCache()->find(variant, modified, size, &skeyboard)) {
+        return skeyboard;
+    }
 
-                                if (mod_binding->label() == label) {
-                                    the_binding = mod_binding;
-                                    *shifted = (modifiers->keys() == TagModifiers::Shift);
-                                    break;
-                                }
-                            }
-                        }
+    SharedParsedLayout layout(sharedLayoutCache()->cachedLayout(id, modified, size));
 
-                        if (the_binding) {
-                            pair.first = key;
-                            pair.second = the_binding;
-                            return pair;
-                        }
-                    }
-                }
-            }
-        }
+    if (not layout && sharedLayoutCache()->hasCompiledLayout(id)) {
+        layout = sharedLayoutCache()->layout(id);
     }
-    return pair;
-}
 
-Keyboard getImportedKeyboard(const QString &id,
-                             ParserFunc func,
-                             const QString &file_prefix,
-                             const QString &default_file,
-                             int page = 0)
-{
-    QString path(getLanguagesDir() + "/" + id + ".xml");
-    QFile file(path);
+    if (layout) {
+        skeyboard = getKeyboard(layout->keyboard, variant.shifted, variant.page, variant.dead_label);
+    } else {
+        QFile file(path);
+        bool built(false);
 
-    if (file.exists()) {
-        file.open(QIODevice::ReadOnly);
+        if (file.open(QIODevice::ReadOnly)) {
+            KeyboardBuilder builder(&file);
 
-        LayoutParser parser(&file);
-        const bool result(parser.parse());
+            built = builder.build(variant.shifted, variant.page, variant.dead_label);
 
-        file.close();
-        if (result) {
-            const QStringList f_results((parser.*func)());
+            if (built) {
+                skeyboard = builder.keyboard();
+            } else {
+                qWarning() << __PRETTY_FUNCTION__ << "Could not build keyboard from file:" << path << ", error:" << builder.errorString();
+            }
+        }
 
-            Q_FOREACH (const QString &f_result, f_results) {
-                const QFileInfo file_info(getLanguagesDir() + "/" + f_result);
+        // The full parser reports what is wrong with the file.
+        if (not built) {
+            const TagKeyboardPtr keyboard(getTagKeyboard(id));
 
-                if (file_info.exists() and file_info.isFile()) {
-                    const TagKeyboardPtr keyboard(getTagKeyboard(file_info.baseName()));
-                    return getKeyboard(keyboard, false, page);
-                }
+            if (not keyboard) {
+                return Keyboard();
             }
 
-            // If we got there then it means that we got xml layout file that does not use
-            // new <import> syntax or just does not specify explicitly which file to import.
-            // In this case we have to search imports list for entry with filename beginning
-            // with file_prefix.
-            const QStringList imports(parser.imports());
-            const QRegExp file_regexp("^(" + file_prefix + ".*).xml$");
+            skeyboard = getKeyboard(keyboard, variant.shifted, variant.page, variant.dead_label);
+        }
+    }
 
-            Q_FOREACH (const QString &import, imports) {
-                if (file_regexp.exactMatch(import)) {
-                    QFileInfo file_info(getLanguagesDir() + "/" + import);
+    sharedVariantCache()->insert(variant, modified, size, skeyboard);
+    return skeyboard;
+}
 
-                    if (file_info.exists() and file_info.isFile()) {
-                        const TagKeyboardPtr keyboard(getTagKeyboard(file_regexp.cap(1)));
-                        return getKeyboard(keyboard, false, page);
-                    }
-                }
-            }
+// Collects the labels of all dead keys of a keyboard.
+void appendDeadLabels(QStringList *labels,
+                      const Keyboard &keyboard)
+{
+    Q_FOREACH (const Key &key, keyboard.keys) {
+        if (key.action() == Key::ActionDead
+            and not labels->contains(key.label().text())) {
+            labels->append(key.label().text());
+        }
+    }
+}
 
-            // If we got there then we try to just load a file with name in default_file.
-            QFileInfo file_info(getLanguagesDir() + "/" + default_file);
+Keyboard getImportedKeyboard(const QString &id,
+                             LanguageIndex::ImportKind kind,
+                             int page = 0)
+{
+    bool fallback(false);
+    const QString imported_id(sharedLanguageIndex()->resolveImport(id, kind, &fallback));
 
-            if (file_info.exists() and file_info.isFile()) {
-                const TagKeyboardPtr keyboard(getTagKeyboard(file_info.baseName()));
-                return getKeyboard(keyboard, false);
-            }
-        } else {
-            qWarning() << __PRETTY_FUNCTION__ << "Could not parse file:" << path << ", error:" << parser.errorString();
-        }
-    } else {
-        qWarning() << __PRETTY_FUNCTION__ << "File not found:" << path;
+    if (imported_id.isEmpty()) {
+        return Keyboard();
     }
-    return Keyboard();
+
+    // Keyboards are cached by the imported id, so all languages importing the
+    // same layout share them. The default layout is always shown with its
+    // first page.
+    return getCachedKeyboard(imported_id, false, fallback ? 0 : page);
 }
 
+// Preloads layouts and their imports on a worker thread. Everything built
+// ends up in the shared, thread-safe caches, where the GUI thread picks it
+// up on the next language switch.
+class PrefetchJob
+    : public QRunnable
+{
+public:
+    PrefetchJob(QObject *loader,
+                const QStringList &ids)
+        : m_loader(loader)
+        , m_ids(ids)
+    {}
+
+    virtual void run()
+    {
+        Q_FOREACH (const QString &id, m_ids) {
+            KeyboardLoader::preload(id);
+
+            QMetaObject::invokeMethod(m_loader, "layoutPrefetched", Qt::QueuedConnection,
+                                      Q_ARG(QString, id));
+        }
+    }
+
+private:
+    QObject *const m_loader;
+    const QStringList m_ids;
+};
+
 } // anonymous namespace
 
 namespace MaliitKeyboard {
@@ -382,6 +348,22 @@ class KeyboardLoaderPrivate
 public:
 
     QString active_id;
+    bool eager_variants;
+    QThreadPool prefetch_pool;
+
+    KeyboardLoaderPrivate()
+        : active_id()
+        , eager_variants(false)
+        , prefetch_pool()
+    {
+        prefetch_pool.setMaxThreadCount(1);
+    }
+
+    ~KeyboardLoaderPrivate()
+    {
+        prefetch_pool.clear();
+        prefetch_pool.waitForDone();
+    }
 };
 
 KeyboardLoader::KeyboardLoader(QObject *parent)
@@ -394,28 +376,24 @@ KeyboardLoader::KeyboardLoader(QObject *parent)
 KeyboardLoader::~KeyboardLoader()
 {}
 
-QStringList KeyboardLoader::ids() const
+//! \brief Returns the cache of parsed layout files shared by all loaders.
+//!
+//! Use it to inspect hit/miss statistics or to invalidate layouts that
+//! changed in ways not covered by the file modification check.
+LayoutCache * KeyboardLoader::layoutCache()
 {
-    QStringList ids;
-    QDir dir(getLanguagesDir(),
-             "*.xml",
-             QDir::Name | QDir::IgnoreCase,
-             QDir::Files | QDir::NoSymLinks | QDir::Readable);
-
-    if (dir.exists()) {
-        QFileInfoList file_infos(dir.entryInfoList());
+    return sharedLayoutCache();
+}
 
-        Q_FOREACH (const QFileInfo &file_info, file_infos) {
-            QFile file(file_info.filePath());
-            file.open(QIODevice::ReadOnly);
-            LayoutParser parser(&file);
+//! \brief Returns the cheaply revalidated index of all layout files.
+LanguageIndex * KeyboardLoader::languageIndex()
+{
+    return sharedLanguageIndex();
+}
 
-            if (parser.isLanguageFile()) {
-                ids.append(file_info.baseName());
-            }
-        }
-    }
-    return ids;
+QStringList KeyboardLoader::ids() const
+{
+    return sharedLanguageIndex()->ids();
 }
 
 QString KeyboardLoader::activeId() const
@@ -431,28 +409,150 @@ void KeyboardLoader::setActiveId(const QString &id)
     if (d->active_id != id) {
         d->active_id = id;
 
+        if (d->eager_variants) {
+            QTimer::singleShot(0, this, SLOT(prebuildVariants()));
+        }
+
         // FIXME: Emit only after parsing new keyboard.
         Q_EMIT keyboardsChanged();
     }
 }
 
-QString KeyboardLoader::title(const QString &id) const
+//! \brief Returns whether variants of a layout are built right after it got
+//!        activated.
+bool KeyboardLoader::eagerVariantsEnabled() const
+{
+    Q_D(const KeyboardLoader);
+    return d->eager_variants;
+}
+
+//! \brief Enables building shifted, dead key and symbol variants of a layout
+//!        from the event loop, right after it got activated.
+void KeyboardLoader::setEagerVariantsEnabled(bool enabled)
 {
-    const TagKeyboardPtr keyboard(getTagKeyboard(id));
+    Q_D(KeyboardLoader);
+    d->eager_variants = enabled;
+}
 
-    if (keyboard) {
-        return keyboard->title();
+//! \brief Builds and caches all variants of the active layout, so that
+//!        toggling shift or entering accent mode only copies a keyboard.
+void KeyboardLoader::prebuildVariants()
+{
+    Q_D(const KeyboardLoader);
+    const Keyboard keyboard(getCachedKeyboard(d->active_id));
+
+    if (keyboard.keys.isEmpty()) {
+        return;
+    }
+
+    // The dead keys are taken from the built keyboards, which does not
+    // require a parse tree of the layout:
+    QStringList dead_labels;
+    appendDeadLabels(&dead_labels, keyboard);
+    appendDeadLabels(&dead_labels, getCachedKeyboard(d->active_id, true));
+
+    Q_FOREACH (const QString &dead_label, dead_labels) {
+        getCachedKeyboard(d->active_id, false, 0, dead_label);
+        getCachedKeyboard(d->active_id, true, 0, dead_label);
+    }
+
+    symbolsKeyboard(0);
+    symbolsKeyboard(1);
+}
+
+//! \brief Prepares layouts, including their symbols and number imports, on
+//!        a worker thread.
+//!
+//! Meant for the layouts the user is likely to switch to next, e.g. the
+//! host's surrounding subviews. Replaces prefetches still pending from a
+//! previous call, as they are of no use anymore after a layout switch.
+//! \param ids The layout ids, the active one is skipped.
+void KeyboardLoader::prefetch(const QStringList &ids)
+{
+    Q_D(KeyboardLoader);
+    QStringList prefetch_ids;
+
+    Q_FOREACH (const QString &id, ids) {
+        if (not id.isEmpty() && id != d->active_id && not prefetch_ids.contains(id)) {
+            prefetch_ids.append(id);
+        }
+    }
+
+    d->prefetch_pool.clear();
+
+    if (not prefetch_ids.isEmpty()) {
+        d->prefetch_pool.start(new PrefetchJob(this, prefetch_ids));
+    }
+}
+
+//! \brief Blocks until all pending prefetches are done.
+void KeyboardLoader::waitForPrefetch()
+{
+    Q_D(KeyboardLoader);
+    d->prefetch_pool.waitForDone();
+}
+
+//! \brief Loads a layout and everything it imports into the shared caches.
+//!
+//! Builds the main, symbols, number and phone number keyboards. Thread-safe,
+//! so it can be used to prepare layouts on worker threads.
+//! \param id The layout id.
+//! \param errors If not null, set to problems found in the layout or its
+//!        imports.
+//! \returns Whether the layout and all its imports could be loaded.
+bool KeyboardLoader::preload(const QString &id,
+                             QStringList *errors)
+{
+    QStringList dummy_errors;
+    QString error;
+
+    if (not errors) {
+        errors = &dummy_errors;
+    }
+
+    const SharedParsedLayout layout(sharedLayoutCache()->layout(id, &error));
+
+    if (not layout) {
+        errors->append(id + ": " + error);
+        return false;
+    }
+
+    const QStringList imported_files(layout->imports + layout->symviews
+                                     + layout->numbers + layout->phonenumbers);
+
+    Q_FOREACH (const QString &imported_file, imported_files) {
+        const QString imported_id(QFileInfo(imported_file).baseName());
+
+        if (not sharedLayoutCache()->layout(imported_id, &error)) {
+            errors->append(imported_id + ": " + error);
+        }
     }
 
-    return QString();
+    getCachedKeyboard(id);
+    getImportedKeyboard(id, LanguageIndex::SymbolsImport);
+    getImportedKeyboard(id, LanguageIndex::NumberImport);
+    getImportedKeyboard(id, LanguageIndex::PhoneNumberImport);
+
+    return errors->isEmpty();
+}
+
+//! \brief Returns the cache of keyboards built from parsed layouts, shared
+//!        by all loaders.
+KeyboardVariantCache * KeyboardLoader::variantCache()
+{
+    return sharedVariantCache();
+}
+
+QString KeyboardLoader::title(const QString &id) const
+{
+    return sharedLanguageIndex()->title(id);
 }
 
 Keyboard KeyboardLoader::keyboard() const
 {
     Q_D(const KeyboardLoader);
-    TagKeyboardPtr keyboard(getTagKeyboard(d->active_id));
 
-    return getKeyboard(keyboard);
+    return getCachedKeyboard(d->active_id);
 }
 
 Keyboard KeyboardLoader::nextKeyboard() const
@@ -471,9 +571,7 @@ Keyboard KeyboardLoader::nextKeyboard() const
         next_index = 0;
     }
 
-    TagKeyboardPtr keyboard(getTagKeyboard(all_ids[next_index]));
-
-    return getKeyboard(keyboard);
+    return getCachedKeyboard(all_ids[next_index]);
 }
 
 Keyboard KeyboardLoader::previousKeyboard() const
@@ -492,60 +590,52 @@ Keyboard KeyboardLoader::previousKeyboard() const
         previous_index = 0;
     }
 
-    TagKeyboardPtr keyboard(getTagKeyboard(all_ids[previous_index]));
-
-    return getKeyboard(keyboard);
+    return getCachedKeyboard(all_ids[previous_index]);
 }
 
 Keyboard KeyboardLoader::shiftedKeyboard() const
 {
     Q_D(const KeyboardLoader);
-    TagKeyboardPtr keyboard(getTagKeyboard(d->active_id));
 
-    return getKeyboard(keyboard, true);
+    return getCachedKeyboard(d->active_id, true);
 }
 
 Keyboard KeyboardLoader::symbolsKeyboard(int page) const
 {
     Q_D(const KeyboardLoader);
 
-    return getImportedKeyboard(d->active_id, &LayoutParser::symviews, "symbols", "symbols_en.xml", page);
+    return getImportedKeyboard(d->active_id, LanguageIndex::SymbolsImport, page);
 }
 
 Keyboard KeyboardLoader::deadKeyboard(const Key &dead) const
 {
     Q_D(const KeyboardLoader);
-    TagKeyboardPtr keyboard(getTagKeyboard(d->active_id));
 
-    return getKeyboard(keyboard, false, 0, dead.label().text());
+    return getCachedKeyboard(d->active_id, false, 0, dead.label().text());
 }
 
 Keyboard KeyboardLoader::shiftedDeadKeyboard(const Key &dead) const
 {
     Q_D(const KeyboardLoader);
-    TagKeyboardPtr keyboard(getTagKeyboard(d->active_id));
 
-    return getKeyboard(keyboard, true, 0, dead.label().text());
+    return getCachedKeyboard(d->active_id, true, 0, dead.label().text());
 }
 
 Keyboard KeyboardLoader::extendedKeyboard(const Key &key) const
 {
-    // Hotfix for suppressing long-press on space bringing up extended keys if
-    // another key has empty label, in given layout.
-    // FIXME: Make extended keyboard/keyarea part of key model instead, to
-    // avoid wrong lookups.
-    if (key.action() == Key::ActionSpace) {
-        return Keyboard();
-    }
-
     Q_D(const KeyboardLoader);
-    const TagKeyboardPtr keyboard(getTagKeyboard(d->active_id));
-    bool shifted(false);
-    const QPair<TagKeyPtr, TagBindingPtr> pair(getTagKeyAndBinding(keyboard, key.label().text(), &shifted));
+    const SharedParsedLayout layout(sharedLayoutCache()->layout(d->active_id));
     Keyboard skeyboard;
 
-    if (pair.first and pair.second) {
-        const TagExtendedPtr extended(pair.first->extended());
+    if (not layout) {
+        return skeyboard;
+    }
+
+    const ExtendedKeyBinding found(layout->extended_keys.value(ExtendedKeyId(key.action(), key.label().text())));
+    const bool shifted(found.shifted);
+
+    if (found.key) {
+        const TagExtendedPtr extended(found.key->extended());
 
         if (extended) {
             const TagRowPtrs rows(extended->rows());
@@ -608,14 +698,14 @@ Keyboard KeyboardLoader::numberKeyboard() const
 {
     Q_D(const KeyboardLoader);
 
-    return getImportedKeyboard(d->active_id, &LayoutParser::numbers, "number", "number.xml");
+    return getImportedKeyboard(d->active_id, LanguageIndex::NumberImport);
 }
 
 Keyboard KeyboardLoader::phoneNumberKeyboard() const
 {
     Q_D(const KeyboardLoader);
 
-    return getImportedKeyboard(d->active_id, &LayoutParser::phonenumbers, "phonenumber", "phonenumber.xml");
+    return getImportedKeyboard(d->active_id, LanguageIndex::PhoneNumberImport);
 }
 
 } // namespace MaliitKeyboard
@@ -41,6 +41,9 @@
 namespace MaliitKeyboard {
 
 class KeyboardLoaderPrivate;
+class LayoutCache;
+class LanguageIndex;
+class KeyboardVariantCache;
 
 class KeyboardLoader
     : public QObject
@@ -71,7 +74,22 @@ public:
     virtual Keyboard numberKeyboard() const;
     virtual Keyboard phoneNumberKeyboard() const;
 
+    bool eagerVariantsEnabled() const;
+    void setEagerVariantsEnabled(bool enabled);
+    Q_SLOT void prebuildVariants();
+
+    void prefetch(const QStringList &ids);
+    void waitForPrefetch();
+
     Q_SIGNAL void keyboardsChanged() const;
+    //! Emitted on the loader's thread once a layout was prefetched.
+    Q_SIGNAL void layoutPrefetched(const QString &id) const;
+
+    static LayoutCache * layoutCache();
+    static LanguageIndex * languageIndex();
+    static KeyboardVariantCache * variantCache();
+    static bool preload(const QString &id,
+                        QStringList *errors = 0);
 
 private:
     const QScopedPointer<KeyboardLoaderPrivate> d_ptr;
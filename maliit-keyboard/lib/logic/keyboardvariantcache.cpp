@@ -0,0 +1,195 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012 Openismus GmbH. All rights reserved.
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "keyboardvariantcache.h"
+
+namespace MaliitKeyboard {
+
+//! \class KeyboardVariantCache
+//! Keeps keyboards already built from a layout file, for each combination
+//! of shift state, section page and dead key. Like in LayoutCache, entries
+//! are revalidated against the modification time and size of the layout
+//! file they were built from, so an edited file invalidates its variants.
+//! All methods are thread-safe.
+
+KeyboardVariant::KeyboardVariant(const QString &new_id,
+                                 bool new_shifted,
+                                 int new_page,
+                                 const QString &new_dead_label)
+    : id(new_id)
+    , shifted(new_shifted)
+    , page(new_page)
+    , dead_label(new_dead_label)
+{}
+
+
+bool operator==(const KeyboardVariant &lhs,
+                const KeyboardVariant &rhs)
+{
+    return (lhs.id == rhs.id
+            && lhs.shifted == rhs.shifted
+            && lhs.page == rhs.page
+            && lhs.dead_label == rhs.dead_label);
+}
+
+
+uint qHash(const KeyboardVariant &variant)
+{
+    return (qHash(variant.id) ^ qHash(variant.dead_label)
+            ^ (static_cast<uint>(variant.page) << 1) ^ static_cast<uint>(variant.shifted));
+}
+
+
+//! \param capacity The maximum number of keyboards kept in memory.
+KeyboardVariantCache::KeyboardVariantCache(int capacity)
+    : m_entries(capacity)
+    , m_hits(0)
+    , m_misses(0)
+{}
+
+
+KeyboardVariantCache::~KeyboardVariantCache()
+{}
+
+
+//! \brief Looks up a keyboard variant.
+//! \param variant The variant to look up.
+//! \param modified The current modification time of the layout file.
+//! \param size The current size of the layout file.
+//! \param keyboard Set to the cached keyboard, if found.
+//! \returns Whether an up-to-date keyboard was found.
+bool KeyboardVariantCache::find(const KeyboardVariant &variant,
+                                const QDateTime &modified,
+                                qint64 size,
+                                Keyboard *keyboard)
+{
+    QMutexLocker locker(&m_mutex);
+
+    const Entry *const cached(m_entries.object(variant));
+
+    if (cached && cached->modified == modified && cached->size == size) {
+        ++m_hits;
+        *keyboard = cached->keyboard;
+        return true;
+    }
+
+    ++m_misses;
+    return false;
+}
+
+
+//! \brief Stores a keyboard built from a layout file with given
+//!        modification time and size.
+void KeyboardVariantCache::insert(const KeyboardVariant &variant,
+                                  const QDateTime &modified,
+                                  qint64 size,
+                                  const Keyboard &keyboard)
+{
+    QMutexLocker locker(&m_mutex);
+
+    Entry *entry(new Entry);
+
+    entry->modified = modified;
+    entry->size = size;
+    entry->keyboard = keyboard;
+    m_entries.insert(variant, entry);
+}
+
+
+//! \brief Returns the maximum number of cached keyboards.
+int KeyboardVariantCache::capacity() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_entries.maxCost();
+}
+
+
+//! \brief Sets the maximum number of cached keyboards.
+void KeyboardVariantCache::setCapacity(int capacity)
+{
+    QMutexLocker locker(&m_mutex);
+    m_entries.setMaxCost(qMax(0, capacity));
+}
+
+
+//! \brief Returns the number of currently cached keyboards.
+int KeyboardVariantCache::count() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_entries.count();
+}
+
+
+//! \brief Returns how many lookups were answered from the cache.
+int KeyboardVariantCache::hits() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_hits;
+}
+
+
+//! \brief Returns how many lookups required building a keyboard.
+int KeyboardVariantCache::misses() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_misses;
+}
+
+
+//! \brief Resets hit and miss counters to zero.
+void KeyboardVariantCache::resetStatistics()
+{
+    QMutexLocker locker(&m_mutex);
+    m_hits = 0;
+    m_misses = 0;
+}
+
+
+//! \brief Drops all variants of a given layout id.
+void KeyboardVariantCache::invalidate(const QString &id)
+{
+    QMutexLocker locker(&m_mutex);
+    Q_FOREACH (const KeyboardVariant &variant, m_entries.keys()) {
+        if (variant.id == id) {
+            m_entries.remove(variant);
+        }
+    }
+}
+
+
+//! \brief Drops all cached keyboards.
+void KeyboardVariantCache::invalidateAll()
+{
+    QMutexLocker locker(&m_mutex);
+    m_entries.clear();
+}
+
+} // namespace MaliitKeyboard
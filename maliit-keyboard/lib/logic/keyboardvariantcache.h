@@ -0,0 +1,107 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012 Openismus GmbH. All rights reserved.
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef MALIIT_KEYBOARD_KEYBOARDVARIANTCACHE_H
+#define MALIIT_KEYBOARD_KEYBOARDVARIANTCACHE_H
+
+#include "models/keyboard.h"
+
+#include <QtCore>
+
+namespace MaliitKeyboard {
+
+//! Identifies one keyboard derived from a layout file.
+struct KeyboardVariant
+{
+    QString id;
+    bool shifted;
+    int page;
+    QString dead_label;
+
+    explicit KeyboardVariant(const QString &new_id = QString(),
+                             bool new_shifted = false,
+                             int new_page = 0,
+                             const QString &new_dead_label = QString());
+};
+
+bool operator==(const KeyboardVariant &lhs,
+                const KeyboardVariant &rhs);
+uint qHash(const KeyboardVariant &variant);
+
+class KeyboardVariantCache
+{
+    Q_DISABLE_COPY(KeyboardVariantCache)
+
+private:
+    struct Entry
+    {
+        QDateTime modified;
+        qint64 size;
+        Keyboard keyboard;
+    };
+
+    mutable QMutex m_mutex;
+    QCache<KeyboardVariant, Entry> m_entries;
+    int m_hits;
+    int m_misses;
+
+public:
+    enum {
+        DefaultCapacity = 64
+    };
+
+    explicit KeyboardVariantCache(int capacity = DefaultCapacity);
+    virtual ~KeyboardVariantCache();
+
+    bool find(const KeyboardVariant &variant,
+              const QDateTime &modified,
+              qint64 size,
+              Keyboard *keyboard);
+    void insert(const KeyboardVariant &variant,
+                const QDateTime &modified,
+                qint64 size,
+                const Keyboard &keyboard);
+
+    int capacity() const;
+    void setCapacity(int capacity);
+    int count() const;
+
+    int hits() const;
+    int misses() const;
+    void resetStatistics();
+
+    void invalidate(const QString &id);
+    void invalidateAll();
+};
+
+} // namespace MaliitKeyboard
+
+#endif // MALIIT_KEYBOARD_KEYBOARDVARIANTCACHE_H
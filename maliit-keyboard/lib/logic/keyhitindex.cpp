@@ -0,0 +1,145 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012 Openismus GmbH. All rights reserved.
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "keyhitindex.h"
+
+namespace MaliitKeyboard {
+namespace Logic {
+namespace {
+
+// Enough cells for each to overlap only a few keys of a typical layout.
+const int GridColumns = 16;
+const int GridRows = 8;
+
+}
+
+KeyHitIndex::KeyHitIndex()
+    : m_bounds()
+    , m_rects()
+    , m_cell_offsets()
+    , m_cell_keys()
+{}
+
+//! \brief Indexes the reactive areas (rectangles) of keys.
+//! \param keys The keys, in key area coordinates. keyAt() returns indices
+//!             into this vector.
+void KeyHitIndex::build(const QVector<Key> &keys)
+{
+    clear();
+
+    m_rects.reserve(keys.count());
+
+    Q_FOREACH (const Key &key, keys) {
+        const QRect &rect(key.rect());
+        m_rects.append(rect);
+
+        if (not rect.isEmpty()) {
+            m_bounds |= rect;
+        }
+    }
+
+    if (m_bounds.isEmpty()) {
+        clear();
+        return;
+    }
+
+    QVector<QVector<int> > cells(GridColumns * GridRows);
+
+    for (int index = 0; index < m_rects.count(); ++index) {
+        const QRect &rect(m_rects.at(index));
+
+        if (rect.isEmpty()) {
+            continue;
+        }
+
+        for (int r = row(rect.top()); r <= row(rect.bottom()); ++r) {
+            for (int c = column(rect.left()); c <= column(rect.right()); ++c) {
+                cells[r * GridColumns + c].append(index);
+            }
+        }
+    }
+
+    // Flatten the cells, keeping keys in their original order so that the
+    // first matching key wins, as with a linear search:
+    m_cell_offsets.reserve(cells.count() + 1);
+
+    Q_FOREACH (const QVector<int> &cell, cells) {
+        m_cell_offsets.append(m_cell_keys.count());
+        m_cell_keys += cell;
+    }
+
+    m_cell_offsets.append(m_cell_keys.count());
+}
+
+void KeyHitIndex::clear()
+{
+    m_bounds = QRect();
+    m_rects.clear();
+    m_cell_offsets.clear();
+    m_cell_keys.clear();
+}
+
+bool KeyHitIndex::isEmpty() const
+{
+    return m_cell_offsets.isEmpty();
+}
+
+//! \brief Returns the index of the first key containing pos, or -1.
+int KeyHitIndex::keyAt(const QPoint &pos) const
+{
+    if (isEmpty() || not m_bounds.contains(pos)) {
+        return -1;
+    }
+
+    const int cell(row(pos.y()) * GridColumns + column(pos.x()));
+
+    for (int offset = m_cell_offsets.at(cell); offset < m_cell_offsets.at(cell + 1); ++offset) {
+        const int index(m_cell_keys.at(offset));
+
+        if (m_rects.at(index).contains(pos)) {
+            return index;
+        }
+    }
+
+    return -1;
+}
+
+int KeyHitIndex::column(int x) const
+{
+    return qBound(0, (x - m_bounds.left()) * GridColumns / m_bounds.width(), GridColumns - 1);
+}
+
+int KeyHitIndex::row(int y) const
+{
+    return qBound(0, (y - m_bounds.top()) * GridRows / m_bounds.height(), GridRows - 1);
+}
+
+}} // namespace Logic, MaliitKeyboard
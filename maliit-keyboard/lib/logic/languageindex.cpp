@@ -0,0 +1,456 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012 Openismus GmbH. All rights reserved.
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "languageindex.h"
+#include "parser/layoutparser.h"
+
+namespace MaliitKeyboard {
+
+//! \class LanguageIndex
+//! Knows title, language, autocapitalization and import targets of every
+//! layout file in a languages directory without parsing the layouts
+//! themselves. The index is revalidated by the modification time of the
+//! directory, so adding, removing or replacing a layout file triggers a
+//! rescan, and it is stored in the user's cache directory so that a new
+//! process can reuse it without opening any layout file. All public methods
+//! are thread-safe.
+
+namespace {
+
+const quint32 IndexMagic(0x4d4b4c49); // "MKLI"
+const quint32 IndexVersion(1);
+
+QDataStream & operator<<(QDataStream &stream,
+                         const LanguageIndexEntry &entry)
+{
+    return stream << entry.id << entry.title << entry.language
+                  << entry.autocapitalization << entry.imports
+                  << entry.symviews << entry.numbers << entry.phonenumbers;
+}
+
+QDataStream & operator>>(QDataStream &stream,
+                         LanguageIndexEntry &entry)
+{
+    return stream >> entry.id >> entry.title >> entry.language
+                  >> entry.autocapitalization >> entry.imports
+                  >> entry.symviews >> entry.numbers >> entry.phonenumbers;
+}
+
+bool readEntry(const QFileInfo &file_info,
+               LanguageIndexEntry *entry)
+{
+    QFile file(file_info.filePath());
+
+    if (not file.open(QIODevice::ReadOnly)) {
+        qWarning() << __PRETTY_FUNCTION__ << "Could not open file:" << file_info.filePath();
+        return false;
+    }
+
+    LayoutParser parser(&file);
+
+    if (not parser.parseHeader()) {
+        qWarning() << __PRETTY_FUNCTION__ << "Could not parse file:" << file_info.filePath()
+                   << ", error:" << parser.errorString();
+        return false;
+    }
+
+    const TagKeyboardPtr keyboard(parser.keyboard());
+
+    entry->id = file_info.baseName();
+    entry->title = keyboard->title();
+    entry->language = keyboard->language();
+    entry->autocapitalization = keyboard->autocapitalization();
+    entry->imports = parser.imports();
+    entry->symviews = parser.symviews();
+    entry->numbers = parser.numbers();
+    entry->phonenumbers = parser.phonenumbers();
+
+    return true;
+}
+
+} // unnamed namespace
+
+LanguageIndexEntry::LanguageIndexEntry()
+    : id()
+    , title()
+    , language()
+    , autocapitalization(true)
+    , imports()
+    , symviews()
+    , numbers()
+    , phonenumbers()
+{}
+
+
+//! \brief Returns whether the file is a selectable language layout (and not
+//!        only imported by one).
+bool LanguageIndexEntry::isLanguage() const
+{
+    return not language.isEmpty();
+}
+
+
+//! \param directory The directory containing the language layout files.
+//! \param cache_file Where to store the index. Uses defaultCacheFile() if
+//!        empty.
+LanguageIndex::LanguageIndex(const QString &directory,
+                             const QString &cache_file)
+    : m_directory(directory)
+    , m_cache_file(cache_file.isEmpty() ? defaultCacheFile(directory) : cache_file)
+    , m_modified()
+    , m_loaded(false)
+    , m_entries()
+    , m_ids()
+    , m_scans(0)
+{}
+
+
+LanguageIndex::~LanguageIndex()
+{}
+
+
+//! \brief Returns the per-user index file location for a languages directory.
+QString LanguageIndex::defaultCacheFile(const QString &directory)
+{
+    const QByteArray hash(QCryptographicHash::hash(QFileInfo(directory).absoluteFilePath().toUtf8(),
+                                                   QCryptographicHash::Md5).toHex());
+
+    return (QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation)
+            + "/maliit-keyboard/languages-" + QString::fromLatin1(hash) + ".index");
+}
+
+
+//! \brief Returns the indexed languages directory.
+QString LanguageIndex::directory() const
+{
+    return m_directory;
+}
+
+
+//! \brief Returns the file the index is stored in.
+QString LanguageIndex::cacheFile() const
+{
+    return m_cache_file;
+}
+
+
+//! \brief Returns the ids of all language layouts, sorted by file name.
+//!
+//! Checks the directory modification time first and rescans if needed.
+QStringList LanguageIndex::ids()
+{
+    QMutexLocker locker(&m_mutex);
+    revalidate();
+    return m_ids;
+}
+
+
+//! \brief Returns whether there is a layout file (language or not) for id.
+bool LanguageIndex::contains(const QString &id)
+{
+    QMutexLocker locker(&m_mutex);
+    ensureLoaded();
+    return m_entries.contains(id);
+}
+
+
+//! \brief Returns the indexed header of a layout file.
+//!
+//! Does not touch the file system once the index is loaded; call ids() to
+//! pick up changes in the languages directory.
+LanguageIndexEntry LanguageIndex::entry(const QString &id)
+{
+    QMutexLocker locker(&m_mutex);
+    ensureLoaded();
+    return m_entries.value(id);
+}
+
+
+//! \brief Returns the title of a layout, or an empty string for unknown ids.
+QString LanguageIndex::title(const QString &id)
+{
+    return entry(id).title;
+}
+
+
+//! \brief Returns the id of the layout imported by a language layout.
+//!
+//! Explicit imports (e.g. \<symview src="..."/\>) are preferred, then old
+//! style imports of files starting with the kind's prefix, e.g. "symbols",
+//! and finally the kind's default layout, e.g. symbols_en. Resolutions are
+//! remembered until the directory changes, so the many languages sharing
+//! one import only resolve it once each.
+//! \param id The importing language layout.
+//! \param kind Which import to resolve.
+//! \param fallback If not null, set to whether the default layout was used.
+//! \returns The imported layout id, or an empty string.
+QString LanguageIndex::resolveImport(const QString &id,
+                                     ImportKind kind,
+                                     bool *fallback)
+{
+    QMutexLocker locker(&m_mutex);
+    ensureLoaded();
+
+    const QPair<QString, int> key(id, kind);
+    QHash<QPair<QString, int>, ResolvedImport>::const_iterator it(m_resolved_imports.constFind(key));
+
+    if (it == m_resolved_imports.constEnd()) {
+        const QMap<QString, LanguageIndexEntry>::const_iterator entry(m_entries.constFind(id));
+        ResolvedImport resolved;
+
+        resolved.fallback = false;
+
+        if (entry != m_entries.constEnd()) {
+            resolved = findImport(entry.value(), kind);
+        }
+
+        it = m_resolved_imports.insert(key, resolved);
+    }
+
+    if (fallback) {
+        *fallback = it.value().fallback;
+    }
+
+    return it.value().id;
+}
+
+
+//! \brief Rescans the languages directory, regardless of the stored index.
+void LanguageIndex::rebuild()
+{
+    QMutexLocker locker(&m_mutex);
+    scan(QFileInfo(m_directory).lastModified());
+    save();
+}
+
+
+//! \brief Returns how often the languages directory was actually scanned.
+int LanguageIndex::scans() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_scans;
+}
+
+
+void LanguageIndex::ensureLoaded()
+{
+    if (not m_loaded) {
+        revalidate();
+    }
+}
+
+
+LanguageIndex::ResolvedImport LanguageIndex::findImport(const LanguageIndexEntry &entry,
+                                                       ImportKind kind) const
+{
+    static const char *const prefixes[] = { "symbols", "number", "phonenumber" };
+    static const char *const default_ids[] = { "symbols_en", "number", "phonenumber" };
+
+    const QStringList &explicit_imports(kind == SymbolsImport ? entry.symviews
+                                        : kind == NumberImport ? entry.numbers
+                                        : entry.phonenumbers);
+    ResolvedImport resolved;
+
+    resolved.fallback = false;
+
+    Q_FOREACH (const QString &file, explicit_imports) {
+        const QString imported_id(QFileInfo(file).baseName());
+
+        if (m_entries.contains(imported_id)) {
+            resolved.id = imported_id;
+            return resolved;
+        }
+    }
+
+    // Layout files not using the new <import> syntax, or not telling
+    // explicitly which file to import: search the old style imports for a
+    // file name beginning with the prefix.
+    const QRegExp file_regexp(QString::fromLatin1("^(%1.*).xml$").arg(prefixes[kind]));
+
+    Q_FOREACH (const QString &file, entry.imports) {
+        if (file_regexp.exactMatch(file) && m_entries.contains(file_regexp.cap(1))) {
+            resolved.id = file_regexp.cap(1);
+            return resolved;
+        }
+    }
+
+    if (m_entries.contains(default_ids[kind])) {
+        resolved.id = default_ids[kind];
+        resolved.fallback = true;
+    }
+
+    return resolved;
+}
+
+
+void LanguageIndex::revalidate()
+{
+    const QDateTime modified(QFileInfo(m_directory).lastModified());
+
+    if (m_loaded && modified == m_modified) {
+        return;
+    }
+
+    if (not m_loaded && load(modified)) {
+        return;
+    }
+
+    scan(modified);
+    save();
+}
+
+
+void LanguageIndex::scan(const QDateTime &modified)
+{
+    const QDir dir(m_directory,
+                   "*.xml",
+                   QDir::Name | QDir::IgnoreCase,
+                   QDir::Files | QDir::NoSymLinks | QDir::Readable);
+
+    ++m_scans;
+    m_entries.clear();
+    m_ids.clear();
+    m_resolved_imports.clear();
+    m_modified = modified;
+    m_loaded = true;
+
+    if (not dir.exists()) {
+        return;
+    }
+
+    Q_FOREACH (const QFileInfo &file_info, dir.entryInfoList()) {
+        LanguageIndexEntry entry;
+
+        if (readEntry(file_info, &entry)) {
+            m_entries.insert(entry.id, entry);
+
+            if (entry.isLanguage()) {
+                m_ids.append(entry.id);
+            }
+        }
+    }
+}
+
+
+bool LanguageIndex::load(const QDateTime &modified)
+{
+    QFile file(m_cache_file);
+
+    if (not modified.isValid() || not file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_0);
+
+    quint32 magic(0);
+    quint32 version(0);
+    QString directory;
+    QDateTime stored_modified;
+
+    stream >> magic >> version;
+
+    if (magic != IndexMagic || version != IndexVersion) {
+        return false;
+    }
+
+    stream >> directory >> stored_modified;
+
+    if (directory != m_directory || stored_modified != modified) {
+        return false;
+    }
+
+    QMap<QString, LanguageIndexEntry> entries;
+    QStringList ids;
+    quint32 count(0);
+
+    stream >> count;
+
+    for (quint32 index = 0; index < count && stream.status() == QDataStream::Ok; ++index) {
+        LanguageIndexEntry entry;
+
+        stream >> entry;
+        entries.insert(entry.id, entry);
+    }
+
+    stream >> ids;
+
+    if (stream.status() != QDataStream::Ok) {
+        qWarning() << __PRETTY_FUNCTION__ << "Corrupt language index:" << m_cache_file;
+        return false;
+    }
+
+    m_entries = entries;
+    m_ids = ids;
+    m_resolved_imports.clear();
+    m_modified = modified;
+    m_loaded = true;
+
+    return true;
+}
+
+
+bool LanguageIndex::save() const
+{
+    if (not m_modified.isValid()) {
+        return false;
+    }
+
+    const QFileInfo cache_info(m_cache_file);
+
+    if (not QDir().mkpath(cache_info.absolutePath())) {
+        qWarning() << __PRETTY_FUNCTION__ << "Could not create directory:" << cache_info.absolutePath();
+        return false;
+    }
+
+    QSaveFile file(m_cache_file);
+
+    if (not file.open(QIODevice::WriteOnly)) {
+        qWarning() << __PRETTY_FUNCTION__ << "Could not write language index:" << m_cache_file;
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_0);
+
+    stream << IndexMagic << IndexVersion << m_directory << m_modified
+           << static_cast<quint32>(m_entries.count());
+
+    Q_FOREACH (const LanguageIndexEntry &entry, m_entries) {
+        stream << entry;
+    }
+
+    stream << m_ids;
+
+    return file.commit();
+}
+
+} // namespace MaliitKeyboard
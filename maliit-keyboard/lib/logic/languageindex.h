@@ -0,0 +1,116 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012 Openismus GmbH. All rights reserved.
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef MALIIT_KEYBOARD_LANGUAGEINDEX_H
+#define MALIIT_KEYBOARD_LANGUAGEINDEX_H
+
+#include <QtCore>
+
+namespace MaliitKeyboard {
+
+//! Header information of one layout file, as stored in the LanguageIndex.
+struct LanguageIndexEntry
+{
+    QString id;
+    QString title;
+    QString language;
+    bool autocapitalization;
+    QStringList imports;
+    QStringList symviews;
+    QStringList numbers;
+    QStringList phonenumbers;
+
+    LanguageIndexEntry();
+    bool isLanguage() const;
+};
+
+class LanguageIndex
+{
+    Q_DISABLE_COPY(LanguageIndex)
+
+public:
+    enum ImportKind {
+        SymbolsImport,
+        NumberImport,
+        PhoneNumberImport
+    };
+
+private:
+    struct ResolvedImport
+    {
+        QString id;
+        bool fallback;
+    };
+
+    const QString m_directory;
+    const QString m_cache_file;
+    mutable QMutex m_mutex;
+    QDateTime m_modified;
+    bool m_loaded;
+    QMap<QString, LanguageIndexEntry> m_entries;
+    QStringList m_ids;
+    QHash<QPair<QString, int>, ResolvedImport> m_resolved_imports;
+    int m_scans;
+
+public:
+    explicit LanguageIndex(const QString &directory,
+                           const QString &cache_file = QString());
+    virtual ~LanguageIndex();
+
+    static QString defaultCacheFile(const QString &directory);
+
+    QString directory() const;
+    QString cacheFile() const;
+
+    QStringList ids();
+    bool contains(const QString &id);
+    LanguageIndexEntry entry(const QString &id);
+    QString title(const QString &id);
+    QString resolveImport(const QString &id,
+                          ImportKind kind,
+                          bool *fallback = 0);
+
+    void rebuild();
+    int scans() const;
+
+private:
+    void ensureLoaded();
+    ResolvedImport findImport(const LanguageIndexEntry &entry,
+                              ImportKind kind) const;
+    void revalidate();
+    void scan(const QDateTime &modified);
+    bool load(const QDateTime &modified);
+    bool save() const;
+};
+
+} // namespace MaliitKeyboard
+
+#endif // MALIIT_KEYBOARD_LANGUAGEINDEX_H
@@ -0,0 +1,416 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012 Openismus GmbH. All rights reserved.
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "layoutcache.h"
+#include "keyboardvariantcache.h"
+#include "parser/layoutparser.h"
+#include "parser/layoutblob.h"
+#include "models/key.h"
+
+namespace MaliitKeyboard {
+
+//! \class LayoutCache
+//! Keeps the parse trees of recently used language layout files, so that
+//! switching between shifted, dead key and extended views of the same layout
+//! does not parse the XML file again. Entries are keyed by layout id and
+//! revalidated against the file's modification time and size on every
+//! lookup. The number of entries is bounded; the least recently used entry
+//! is dropped first. Layouts compiled by maliit-keyboard-layout-compiler are
+//! read instead of the XML file if they are up to date.
+//!
+//! All methods are thread-safe; layout files are parsed without holding the
+//! lock, so a slow parse does not block lookups of other layouts.
+
+namespace {
+
+// Mirrors the action mapping of the keys KeyboardLoader creates from tags.
+int keyAction(const TagBindingPtr &binding)
+{
+    return (binding->dead() ? Key::ActionDead : static_cast<int>(binding->action()));
+}
+
+void indexBinding(ExtendedKeyIndex *index,
+                  const TagKeyPtr &key,
+                  const TagBindingPtr &binding,
+                  bool shifted)
+{
+    const ExtendedKeyId id(keyAction(binding), binding->label());
+
+    // First key in document order wins, like the linear search did.
+    if (not index->contains(id)) {
+        ExtendedKeyBinding &entry((*index)[id]);
+
+        entry.key = key;
+        entry.binding = binding;
+        entry.shifted = shifted;
+    }
+}
+
+// Indexes all bindings of keys having extended keys in the first section,
+// so that a long press can find its extended keys without a search. The
+// action is part of the index key, which keeps keys without label (e.g. the
+// space bar) apart from other unlabeled keys.
+void buildExtendedKeyIndex(ParsedLayout *layout)
+{
+    if (not layout->keyboard || layout->keyboard->layouts().isEmpty()) {
+        return;
+    }
+
+    // sections cannot be empty - parser does not allow that.
+    const TagRowPtrs rows(layout->keyboard->layouts().first()->sections().first()->rows());
+
+    Q_FOREACH (const TagRowPtr &row, rows) {
+        Q_FOREACH (const TagRowElementPtr &element, row->elements()) {
+            if (element->element_type() != TagRowElement::Key) {
+                continue;
+            }
+
+            const TagKeyPtr key(element.staticCast<TagKey>());
+
+            if (not key->extended()) {
+                continue;
+            }
+
+            const TagBindingPtr binding(key->binding());
+
+            indexBinding(&layout->extended_keys, key, binding, false);
+
+            Q_FOREACH (const TagModifiersPtr &modifiers, binding->modifiers()) {
+                indexBinding(&layout->extended_keys, key, modifiers->binding(),
+                             modifiers->keys() == TagModifiers::Shift);
+            }
+        }
+    }
+}
+
+// Blobs older than their source are stale; the size check in the reader
+// alone does not catch edits keeping the file size.
+bool isCompiledLayoutCurrent(const QString &path,
+                             const QFileInfo &source_info)
+{
+    const QFileInfo blob_info(path);
+
+    return (blob_info.exists() && blob_info.lastModified() >= source_info.lastModified());
+}
+
+SharedParsedLayout readCompiledLayoutFile(const QString &path,
+                                          const QFileInfo &source_info)
+{
+    if (not isCompiledLayoutCurrent(path, source_info)) {
+        return SharedParsedLayout();
+    }
+
+    QFile file(path);
+
+    if (not file.open(QIODevice::ReadOnly)) {
+        qWarning() << __PRETTY_FUNCTION__ << "Could not open file:" << path;
+        return SharedParsedLayout();
+    }
+
+    LayoutBlobReader reader(&file);
+
+    if (not reader.read(source_info.size())) {
+        qWarning() << __PRETTY_FUNCTION__ << "Could not read compiled layout:" << path << ", error:" << reader.errorString();
+        return SharedParsedLayout();
+    }
+
+    ParsedLayout *layout(new ParsedLayout);
+
+    layout->keyboard = reader.keyboard();
+    layout->imports = reader.imports();
+    layout->symviews = reader.symviews();
+    layout->numbers = reader.numbers();
+    layout->phonenumbers = reader.phonenumbers();
+    buildExtendedKeyIndex(layout);
+
+    return SharedParsedLayout(layout);
+}
+
+SharedParsedLayout parseLayoutFile(const QString &path,
+                                   QString *error)
+{
+    QFile file(path);
+
+    if (not file.open(QIODevice::ReadOnly)) {
+        qWarning() << __PRETTY_FUNCTION__ << "Could not open file:" << path;
+        *error = "Could not open file: " + file.errorString();
+        return SharedParsedLayout();
+    }
+
+    LayoutParser parser(&file);
+    const bool result(parser.parse());
+
+    file.close();
+
+    if (not result) {
+        qWarning() << __PRETTY_FUNCTION__ << "Could not parse file:" << path << ", error:" << parser.errorString();
+        *error = parser.errorString();
+        return SharedParsedLayout();
+    }
+
+    ParsedLayout *layout(new ParsedLayout);
+
+    layout->keyboard = parser.keyboard();
+    layout->imports = parser.imports();
+    layout->symviews = parser.symviews();
+    layout->numbers = parser.numbers();
+    layout->phonenumbers = parser.phonenumbers();
+    buildExtendedKeyIndex(layout);
+
+    return SharedParsedLayout(layout);
+}
+
+} // unnamed namespace
+
+ExtendedKeyBinding::ExtendedKeyBinding()
+    : key()
+    , binding()
+    , shifted(false)
+{}
+
+
+//! \param directory The directory containing the language layout files.
+//! \param capacity The maximum number of parsed layouts kept in memory.
+//! \param variants If not null, the cache of keyboards built from these
+//!                 layouts, whose entries get invalidated along with them.
+LayoutCache::LayoutCache(const QString &directory,
+                         int capacity,
+                         KeyboardVariantCache *variants)
+    : m_directory(directory)
+    , m_variants(variants)
+    , m_entries(capacity)
+    , m_hits(0)
+    , m_misses(0)
+{}
+
+
+LayoutCache::~LayoutCache()
+{}
+
+
+//! \brief Returns the directory the layout files are looked up in.
+QString LayoutCache::directory() const
+{
+    return m_directory;
+}
+
+
+//! \brief Returns the parsed layout for a given id.
+//!
+//! Parses the layout file if it is not cached yet or if it changed on disk
+//! since it was cached.
+//! \param id The layout id, which is the base name of the layout file.
+//! \param error If not null, set to the reason of a failure.
+//! \returns The parsed layout, or a null pointer if the file does not exist
+//!          or could not be parsed.
+SharedParsedLayout LayoutCache::layout(const QString &id,
+                                       QString *error)
+{
+    QString dummy_error;
+
+    if (not error) {
+        error = &dummy_error;
+    }
+
+    if (id.isEmpty()) {
+        *error = "Empty layout id.";
+        return SharedParsedLayout();
+    }
+
+    const QString path(m_directory + "/" + id + ".xml");
+    const QFileInfo file_info(path);
+
+    if (not file_info.exists()) {
+        qWarning() << __PRETTY_FUNCTION__ << "File not found:" << path;
+        *error = "File not found: " + path;
+        invalidate(id);
+        return SharedParsedLayout();
+    }
+
+    const QDateTime modified(file_info.lastModified());
+    const qint64 size(file_info.size());
+
+    {
+        QMutexLocker locker(&m_mutex);
+        const Entry *const cached(m_entries.object(id));
+
+        if (cached && cached->modified == modified && cached->size == size) {
+            ++m_hits;
+            return cached->layout;
+        }
+
+        ++m_misses;
+    }
+
+    SharedParsedLayout layout(readCompiledLayoutFile(m_directory + "/" + id + CompiledLayoutSuffix,
+                                                     file_info));
+
+    if (not layout) {
+        layout = parseLayoutFile(path, error);
+    }
+
+    QMutexLocker locker(&m_mutex);
+
+    if (layout) {
+        Entry *entry(new Entry);
+
+        entry->layout = layout;
+        entry->modified = modified;
+        entry->size = size;
+        m_entries.insert(id, entry);
+    } else {
+        m_entries.remove(id);
+    }
+
+    return layout;
+}
+
+
+//! \brief Returns the parsed layout for a given id, but only if it is
+//!        cached already and up to date.
+//!
+//! Never parses and does not count as a lookup in the statistics.
+//! \param id The layout id.
+//! \param modified The current modification time of the layout file.
+//! \param size The current size of the layout file.
+SharedParsedLayout LayoutCache::cachedLayout(const QString &id,
+                                             const QDateTime &modified,
+                                             qint64 size) const
+{
+    QMutexLocker locker(&m_mutex);
+    const Entry *const cached(m_entries.object(id));
+
+    if (cached && cached->modified == modified && cached->size == size) {
+        return cached->layout;
+    }
+
+    return SharedParsedLayout();
+}
+
+
+//! \brief Returns whether a compiled layout, not older than its source,
+//!        exists for a given id.
+//!
+//! Reading it through layout() is cheap then. Whether the compiled layout
+//! is valid is only known after reading it.
+//! \param id The layout id.
+bool LayoutCache::hasCompiledLayout(const QString &id) const
+{
+    const QFileInfo source_info(m_directory + "/" + id + ".xml");
+
+    return (source_info.exists()
+            && isCompiledLayoutCurrent(m_directory + "/" + id + CompiledLayoutSuffix, source_info));
+}
+
+
+//! \brief Returns the maximum number of cached layouts.
+int LayoutCache::capacity() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_entries.maxCost();
+}
+
+
+//! \brief Sets the maximum number of cached layouts.
+//!
+//! Least recently used layouts are dropped if the cache holds more than
+//! capacity layouts.
+void LayoutCache::setCapacity(int capacity)
+{
+    QMutexLocker locker(&m_mutex);
+    m_entries.setMaxCost(qMax(0, capacity));
+}
+
+
+//! \brief Returns the number of currently cached layouts.
+int LayoutCache::count() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_entries.count();
+}
+
+
+//! \brief Returns how many lookups were answered from the cache.
+int LayoutCache::hits() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_hits;
+}
+
+
+//! \brief Returns how many lookups required parsing a layout file.
+int LayoutCache::misses() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_misses;
+}
+
+
+//! \brief Resets hit and miss counters to zero.
+void LayoutCache::resetStatistics()
+{
+    QMutexLocker locker(&m_mutex);
+    m_hits = 0;
+    m_misses = 0;
+}
+
+
+//! \brief Drops the cached layout for a given id.
+//!
+//! The next lookup of that id will parse the layout file again. Keyboards
+//! built from that layout are dropped from the variant cache, too.
+void LayoutCache::invalidate(const QString &id)
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_entries.remove(id);
+    }
+
+    if (m_variants) {
+        m_variants->invalidate(id);
+    }
+}
+
+
+//! \brief Drops all cached layouts, and all keyboards built from them.
+void LayoutCache::invalidateAll()
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_entries.clear();
+    }
+
+    if (m_variants) {
+        m_variants->invalidateAll();
+    }
+}
+
+} // namespace MaliitKeyboard
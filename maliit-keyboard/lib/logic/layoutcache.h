@@ -0,0 +1,123 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012 Openismus GmbH. All rights reserved.
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef MALIIT_KEYBOARD_LAYOUTCACHE_H
+#define MALIIT_KEYBOARD_LAYOUTCACHE_H
+
+#include "parser/alltagtypes.h"
+
+#include <QtCore>
+
+namespace MaliitKeyboard {
+
+class KeyboardVariantCache;
+
+//! A key with extended keys, as found through the binding the user pressed.
+//! The tags belong to the keyboard of the ParsedLayout holding the binding.
+struct ExtendedKeyBinding
+{
+    TagKeyPtr key;
+    TagBindingPtr binding;
+    bool shifted;
+
+    ExtendedKeyBinding();
+};
+
+//! Identifies a pressed key by its Key::Action and label.
+typedef QPair<int, QString> ExtendedKeyId;
+typedef QHash<ExtendedKeyId, ExtendedKeyBinding> ExtendedKeyIndex;
+
+//! Everything a LayoutParser extracts from one language layout file.
+struct ParsedLayout
+{
+    TagKeyboardPtr keyboard;
+    QStringList imports;
+    QStringList symviews;
+    QStringList numbers;
+    QStringList phonenumbers;
+    ExtendedKeyIndex extended_keys;
+};
+
+typedef QSharedPointer<const ParsedLayout> SharedParsedLayout;
+
+class LayoutCache
+{
+    Q_DISABLE_COPY(LayoutCache)
+
+private:
+    struct Entry
+    {
+        SharedParsedLayout layout;
+        QDateTime modified;
+        qint64 size;
+    };
+
+    const QString m_directory;
+    KeyboardVariantCache *const m_variants;
+    mutable QMutex m_mutex;
+    QCache<QString, Entry> m_entries;
+    int m_hits;
+    int m_misses;
+
+public:
+    enum {
+        DefaultCapacity = 8
+    };
+
+    explicit LayoutCache(const QString &directory,
+                         int capacity = DefaultCapacity,
+                         KeyboardVariantCache *variants = 0);
+    virtual ~LayoutCache();
+
+    QString directory() const;
+
+    SharedParsedLayout layout(const QString &id,
+                              QString *error = 0);
+    SharedParsedLayout cachedLayout(const QString &id,
+                                    const QDateTime &modified,
+                                    qint64 size) const;
+    bool hasCompiledLayout(const QString &id) const;
+
+    int capacity() const;
+    void setCapacity(int capacity);
+    int count() const;
+
+    int hits() const;
+    int misses() const;
+    void resetStatistics();
+
+    void invalidate(const QString &id);
+    void invalidateAll();
+};
+
+} // namespace MaliitKeyboard
+
+#endif // MALIIT_KEYBOARD_LAYOUTCACHE_H
@@ -41,24 +41,98 @@ namespace Logic {
 
 namespace {
 
-bool removeKey(QVector<Key> *keys,
-               const Key &key)
+// Keys held down in one panel. Each key identifier has a slot in an array,
+// holding the key's position in keys and how often it is held down, so that
+// pressing and releasing a key takes constant time. A released key is
+// replaced by the last one in keys, hence keys is only in press order as
+// long as no key got released. A key held down more than once is listed
+// once. Keys without an identifier are searched for.
+class ActiveKeys
 {
-    if (not keys) {
-        return false;
+public:
+    QVector<Key> keys;
+
+    void append(const Key &key)
+    {
+        const quint16 id(key.id());
+
+        if (id == 0) {
+            keys.append(key);
+            return;
+        }
+
+        if (id >= m_slots.size()) {
+            m_slots.resize(id + 1);
+        }
+
+        Slot &slot(m_slots[id]);
+
+        if (slot.presses++ == 0) {
+            slot.position = keys.size();
+            keys.append(key);
+        }
     }
 
-    for (int index = 0; index < keys->count(); ++index) {
-        const Key &current(keys->at(index));
-        if (current.origin() == key.origin()
-                && current.label() == key.label()) {
-            keys->remove(index);
-            return true;
+    bool remove(const Key &key)
+    {
+        const quint16 id(key.id());
+        int position(-1);
+
+        if (id == 0) {
+            for (int index = 0; index < keys.count() && position < 0; ++index) {
+                const Key &current(keys.at(index));
+
+                if (current.id() == 0
+                    && current.origin() == key.origin()
+                    && current.label() == key.label()) {
+                    position = index;
+                }
+            }
+        } else if (id < m_slots.size() && m_slots.at(id).presses > 0
+                   && --m_slots[id].presses == 0) {
+            position = m_slots.at(id).position;
         }
+
+        if (position < 0) {
+            return false;
+        }
+
+        const int last(keys.count() - 1);
+
+        if (position != last) {
+            keys[position] = keys.at(last);
+
+            const quint16 moved_id(keys.at(position).id());
+
+            if (moved_id != 0) {
+                m_slots[moved_id].position = position;
+            }
+        }
+
+        keys.resize(last);
+        return true;
     }
 
-    return false;
-}
+    void clear()
+    {
+        keys.clear();
+        m_slots.fill(Slot());
+    }
+
+private:
+    struct Slot
+    {
+        int position;
+        int presses;
+
+        Slot()
+            : position(-1)
+            , presses(0)
+        {}
+    };
+
+    QVector<Slot> m_slots;
+};
 
 struct KeyPredicate
 {
@@ -96,10 +170,10 @@ public:
 
     // TODO: Store active keys in KeyArea
     struct {
-        QVector<Key> left;
-        QVector<Key> right;
-        QVector<Key> center;
-        QVector<Key> extended;
+        ActiveKeys left;
+        ActiveKeys right;
+        ActiveKeys center;
+        ActiveKeys extended;
     } active_keys;
 
     Key magnifier_key;
@@ -344,10 +418,10 @@ QVector<Key> LayoutHelper::activeKeys() const
     Q_D(const LayoutHelper);
 
     switch (d->active_panel) {
-    case LeftPanel: return d->active_keys.left;
-    case RightPanel: return d->active_keys.right;
-    case CenterPanel: return d->active_keys.center;
-    case ExtendedPanel: return d->active_keys.extended;
+    case LeftPanel: return d->active_keys.left.keys;
+    case RightPanel: return d->active_keys.right.keys;
+    case CenterPanel: return d->active_keys.center.keys;
+    case ExtendedPanel: return d->active_keys.extended.keys;
     case NumPanels: break;
     }
 
@@ -380,12 +454,12 @@ void LayoutHelper::appendActiveKey(const Key &key)
 
     case CenterPanel:
         d->active_keys.center.append(key);
-        Q_EMIT activeKeysChanged(d->active_keys.center, d->overriden_keys);
+        Q_EMIT activeKeysChanged(d->active_keys.center.keys, d->overriden_keys);
         break;
 
     case ExtendedPanel:
         d->active_keys.extended.append(key);
-        Q_EMIT activeExtendedKeysChanged(d->active_keys.extended, d->overriden_keys);
+        Q_EMIT activeExtendedKeysChanged(d->active_keys.extended.keys, d->overriden_keys);
         break;
     }
 }
@@ -400,14 +474,14 @@ void LayoutHelper::removeActiveKey(const Key &key)
     case NumPanels: break;
 
     case CenterPanel:
-        if (removeKey(&d->active_keys.center, key)) {
-            Q_EMIT activeKeysChanged(d->active_keys.center, d->overriden_keys);
+        if (d->active_keys.center.remove(key)) {
+            Q_EMIT activeKeysChanged(d->active_keys.center.keys, d->overriden_keys);
         }
         break;
 
     case ExtendedPanel:
-        if (removeKey(&d->active_keys.extended, key)) {
-            Q_EMIT activeExtendedKeysChanged(d->active_keys.extended, d->overriden_keys);
+        if (d->active_keys.extended.remove(key)) {
+            Q_EMIT activeExtendedKeysChanged(d->active_keys.extended.keys, d->overriden_keys);
         }
         break;
     }
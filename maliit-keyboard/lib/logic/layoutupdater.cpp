@@ -34,6 +34,7 @@
 #include "style.h"
 
 #include "models/area.h"
+#include "models/keyarea.h"
 #include "models/keyboard.h"
 #include "models/keydescription.h"
 #include "models/wordribbon.h"
@@ -58,14 +59,17 @@ Key modifyKey(const Key &key,
               KeyDescription::State state,
               const StyleAttributes *attributes)
 {
-    if (not attributes) {
+    // Keys already in the requested state are returned as they are; the
+    // background table is resolved once per style profile.
+    if (not attributes || key.state() == state) {
         return key;
     }
 
+    const KeyBackground &background(attributes->keyStateBackground(key.style(), state));
     Key k(key);
 
-    k.rArea().setBackground(attributes->keyBackground(key.style(), state));
-    k.rArea().setBackgroundBorders(attributes->keyBackgroundBorders());
+    k.setState(state);
+    k.setBackground(background.image, background.borders);
 
     return k;
 }
@@ -205,6 +209,56 @@ Key magnifyKey(const Key &key,
     return magnifier;
 }
 
+//! Identifies a key area converted for the center panel. Besides the
+//! keyboard variant, geometry depends on orientation, style profile and
+//! screen, so these are part of the key as well.
+struct CenterKeyAreaId
+{
+    enum Variant {
+        MainVariant,
+        ShiftedVariant,
+        SymbolsVariant,
+        DeadVariant,
+        ShiftedDeadVariant
+    };
+
+    QString keyboard_id;
+    Variant variant;
+    int page;
+    QString dead_label;
+    LayoutHelper::Orientation orientation;
+    QString profile;
+    QSize screen_size;
+};
+
+bool operator==(const CenterKeyAreaId &lhs,
+                const CenterKeyAreaId &rhs)
+{
+    return (lhs.keyboard_id == rhs.keyboard_id
+            && lhs.variant == rhs.variant
+            && lhs.page == rhs.page
+            && lhs.dead_label == rhs.dead_label
+            && lhs.orientation == rhs.orientation
+            && lhs.profile == rhs.profile
+            && lhs.screen_size == rhs.screen_size);
+}
+
+uint qHash(const CenterKeyAreaId &id)
+{
+    return (qHash(id.keyboard_id) ^ qHash(id.dead_label) ^ qHash(id.profile)
+            ^ (static_cast<uint>(id.variant) << 8) ^ (static_cast<uint>(id.page) << 4)
+            ^ static_cast<uint>(id.orientation)
+            ^ (static_cast<uint>(id.screen_size.width()) << 16) ^ static_cast<uint>(id.screen_size.height()));
+}
+
+//! A converted key area, together with the style name the conversion
+//! selected in the StyleAttributes.
+struct CachedKeyArea
+{
+    KeyArea key_area;
+    QString style_name;
+};
+
 class LayoutUpdaterPrivate
 {
 public:
@@ -217,6 +271,9 @@ public:
     SharedStyle style;
     bool word_ribbon_visible;
     LayoutHelper::Panel close_extended_on_release;
+    QCache<CenterKeyAreaId, CachedKeyArea> key_areas;
+    int key_area_hits;
+    int key_area_misses;
 
     explicit LayoutUpdaterPrivate()
         : initialized(false)
@@ -228,6 +285,9 @@ public:
         , style()
         , word_ribbon_visible(false)
         , close_extended_on_release(LayoutHelper::NumPanels) // NumPanels counts as invalid panel.
+        , key_areas(16)
+        , key_area_hits(0)
+        , key_area_misses(0)
     {}
 
     bool inShiftedState() const
@@ -263,6 +323,64 @@ public:
         return (layout->activePanel() == LayoutHelper::ExtendedPanel
                 ? style->extendedKeysAttributes() : style->attributes());
     }
+
+    // Returns a key area for the center panel, converting it only if it is
+    // not cached yet. Requires layout and style to be set.
+    KeyArea centerKeyArea(CenterKeyAreaId::Variant variant,
+                          int page = 0,
+                          const Key &accent = Key())
+    {
+        CenterKeyAreaId id;
+        id.keyboard_id = loader.activeId();
+        id.variant = variant;
+        id.page = page;
+        id.dead_label = accent.label().text();
+        id.orientation = layout->orientation();
+        id.profile = style->profile();
+        id.screen_size = layout->screenSize();
+
+        StyleAttributes *const attributes(style->attributes());
+        const CachedKeyArea *const cached(key_areas.object(id));
+
+        if (cached) {
+            ++key_area_hits;
+            // Converting selects the keyboard's style name, and magnifier and
+            // word ribbon styling rely on that.
+            attributes->setStyleName(cached->style_name);
+            return cached->key_area;
+        }
+
+        ++key_area_misses;
+
+        KeyAreaConverter converter(attributes, &loader);
+        converter.setLayoutOrientation(id.orientation);
+        CachedKeyArea *entry(new CachedKeyArea);
+
+        switch (variant) {
+        case CenterKeyAreaId::MainVariant:
+            entry->key_area = converter.keyArea();
+            break;
+        case CenterKeyAreaId::ShiftedVariant:
+            entry->key_area = converter.shiftedKeyArea();
+            break;
+        case CenterKeyAreaId::SymbolsVariant:
+            entry->key_area = converter.symbolsKeyArea(page);
+            break;
+        case CenterKeyAreaId::DeadVariant:
+            entry->key_area = converter.deadKeyArea(accent);
+            break;
+        case CenterKeyAreaId::ShiftedDeadVariant:
+            entry->key_area = converter.shiftedDeadKeyArea(accent);
+            break;
+        }
+
+        entry->style_name = attributes->styleName();
+
+        const KeyArea key_area(entry->key_area);
+        key_areas.insert(id, entry);
+
+        return key_area;
+    }
 };
 
 LayoutUpdater::LayoutUpdater(QObject *parent)
@@ -310,6 +428,22 @@ QString LayoutUpdater::keyboardTitle(const QString &id) const
     return d->loader.title(id);
 }
 
+//! \brief Enables building the variants of a layout right after it got
+//!        activated, see KeyboardLoader::setEagerVariantsEnabled().
+void LayoutUpdater::setEagerVariantsEnabled(bool enabled)
+{
+    Q_D(LayoutUpdater);
+    d->loader.setEagerVariantsEnabled(enabled);
+}
+
+//! \brief Prepares the given layouts on a worker thread, see
+//!        KeyboardLoader::prefetch().
+void LayoutUpdater::prefetchKeyboards(const QStringList &ids)
+{
+    Q_D(LayoutUpdater);
+    d->loader.prefetch(ids);
+}
+
 void LayoutUpdater::setLayout(LayoutHelper *layout)
 {
     Q_D(LayoutUpdater);
@@ -327,11 +461,8 @@ void LayoutUpdater::setOrientation(LayoutHelper::Orientation orientation)
 
     if (d->layout && d->style && d->layout->orientation() != orientation) {
         d->layout->setOrientation(orientation);
-
-        KeyAreaConverter converter(d->style->attributes(), &d->loader);
-        converter.setLayoutOrientation(orientation);
-        d->layout->setCenterPanel(d->inShiftedState() ? converter.shiftedKeyArea()
-                                                      : converter.keyArea());
+        d->layout->setCenterPanel(d->centerKeyArea(d->inShiftedState() ? CenterKeyAreaId::ShiftedVariant
+                                                                       : CenterKeyAreaId::MainVariant));
 
         if (isWordRibbonVisible()) {
             WordRibbon ribbon(d->layout->wordRibbon());
@@ -346,7 +477,42 @@ void LayoutUpdater::setOrientation(LayoutHelper::Orientation orientation)
 void LayoutUpdater::setStyle(const SharedStyle &style)
 {
     Q_D(LayoutUpdater);
+
+    if (d->style) {
+        disconnect(d->style.data(), SIGNAL(profileChanged()),
+                   this,            SLOT(clearKeyAreaCache()));
+    }
+
     d->style = style;
+    clearKeyAreaCache();
+
+    if (d->style) {
+        connect(d->style.data(), SIGNAL(profileChanged()),
+                this,            SLOT(clearKeyAreaCache()),
+                Qt::UniqueConnection);
+    }
+}
+
+//! \brief Returns how many center panel key areas were taken from the cache.
+int LayoutUpdater::keyAreaCacheHits() const
+{
+    Q_D(const LayoutUpdater);
+    return d->key_area_hits;
+}
+
+//! \brief Returns how many center panel key areas had to be converted.
+int LayoutUpdater::keyAreaCacheMisses() const
+{
+    Q_D(const LayoutUpdater);
+    return d->key_area_misses;
+}
+
+//! \brief Drops all cached key areas, for instance because the style
+//!        profile changed.
+void LayoutUpdater::clearKeyAreaCache()
+{
+    Q_D(LayoutUpdater);
+    d->key_areas.clear();
 }
 
 bool LayoutUpdater::isWordRibbonVisible() const
@@ -745,10 +911,8 @@ void LayoutUpdater::switchToMainView()
         d->layout->setWordRibbon(ribbon);
     }
 
-    KeyAreaConverter converter(d->style->attributes(), &d->loader);
-    converter.setLayoutOrientation(orientation);
-    d->layout->setCenterPanel(d->inShiftedState() ? converter.shiftedKeyArea()
-                                                  : converter.keyArea());
+    d->layout->setCenterPanel(d->centerKeyArea(d->inShiftedState() ? CenterKeyAreaId::ShiftedVariant
+                                                                   : CenterKeyAreaId::MainVariant));
 }
 
 void LayoutUpdater::switchToPrimarySymView()
@@ -759,10 +923,7 @@ void LayoutUpdater::switchToPrimarySymView()
         return;
     }
 
-    const LayoutHelper::Orientation orientation(d->layout->orientation());
-    KeyAreaConverter converter(d->style->attributes(), &d->loader);
-    converter.setLayoutOrientation(orientation);
-    d->layout->setCenterPanel(converter.symbolsKeyArea(0));
+    d->layout->setCenterPanel(d->centerKeyArea(CenterKeyAreaId::SymbolsVariant, 0));
 
     // Reset shift state machine, also see switchToMainView.
     d->shift_machine.restart();
@@ -776,10 +937,7 @@ void LayoutUpdater::switchToSecondarySymView()
         return;
     }
 
-    const LayoutHelper::Orientation orientation(d->layout->orientation());
-    KeyAreaConverter converter(d->style->attributes(), &d->loader);
-    converter.setLayoutOrientation(orientation);
-    d->layout->setCenterPanel(converter.symbolsKeyArea(1));
+    d->layout->setCenterPanel(d->centerKeyArea(CenterKeyAreaId::SymbolsVariant, 1));
 }
 
 void LayoutUpdater::switchToAccentedView()
@@ -790,13 +948,10 @@ void LayoutUpdater::switchToAccentedView()
         return;
     }
 
-
-    const LayoutHelper::Orientation orientation(d->layout->orientation());
-    KeyAreaConverter converter(d->style->attributes(), &d->loader);
-    converter.setLayoutOrientation(orientation);
     const Key accent(d->deadkey_machine.accentKey());
-    d->layout->setCenterPanel(d->inShiftedState() ? converter.shiftedDeadKeyArea(accent)
-                                                  : converter.deadKeyArea(accent));
+    d->layout->setCenterPanel(d->centerKeyArea(d->inShiftedState() ? CenterKeyAreaId::ShiftedDeadVariant
+                                                                   : CenterKeyAreaId::DeadVariant,
+                                               0, accent));
 }
 
 }} // namespace Logic, MaliitKeyboard
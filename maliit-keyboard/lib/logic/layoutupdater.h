@@ -68,11 +68,18 @@ public:
     void setActiveKeyboardId(const QString &id);
     QString keyboardTitle(const QString &id) const;
 
+    void setEagerVariantsEnabled(bool enabled);
+    void prefetchKeyboards(const QStringList &ids);
+
     void setLayout(LayoutHelper *layout);
     Q_SLOT void setOrientation(LayoutHelper::Orientation orientation);
 
     void setStyle(const SharedStyle &style);
 
+    int keyAreaCacheHits() const;
+    int keyAreaCacheMisses() const;
+    Q_SLOT void clearKeyAreaCache();
+
     bool isWordRibbonVisible() const;
     Q_SLOT void setWordRibbonVisible(bool visible);
     Q_SIGNAL void wordRibbonVisibleChanged(bool visible);
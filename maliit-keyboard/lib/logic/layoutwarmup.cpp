@@ -0,0 +1,300 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012 Openismus GmbH. All rights reserved.
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "layoutwarmup.h"
+#include "keyboardloader.h"
+#include "layoutcache.h"
+#include "keyboardvariantcache.h"
+
+namespace MaliitKeyboard {
+
+namespace {
+
+// Warm-up runs by default, but its timings are only printed when asked for.
+bool reportEnabled()
+{
+    static const QByteArray warm_up(qgetenv("MALIIT_KEYBOARD_WARMUP"));
+    static const QByteArray timeline(qgetenv("MALIIT_KEYBOARD_STARTUP_TIMELINE"));
+
+    return ((not warm_up.isEmpty() && warm_up != "0")
+            || (not timeline.isEmpty() && timeline != "0"));
+}
+
+// A layout is loaded together with up to three imports: symbols, number
+// and phone number layouts.
+const int FilesPerLayout = 4;
+
+// Raises the capacity of the shared caches so that warming up layout_count
+// layouts does not evict what it just loaded. Capacities are never lowered.
+void reserveCacheCapacity(int layout_count)
+{
+    LayoutCache *const layouts(KeyboardLoader::layoutCache());
+    KeyboardVariantCache *const variants(KeyboardLoader::variantCache());
+    // Imports are shared between many layouts, so there are never more
+    // files to keep than there are in the languages directory:
+    const int file_count(QDir(layouts->directory()).entryList(QStringList() << "*.xml",
+                                                              QDir::Files).count());
+    const int files(qMin(layout_count * FilesPerLayout, file_count));
+
+    if (layouts->capacity() < files) {
+        layouts->setCapacity(files);
+    }
+
+    // One keyboard per file, on top of the variants of the layouts in use:
+    if (variants->capacity() < KeyboardVariantCache::DefaultCapacity + files) {
+        variants->setCapacity(KeyboardVariantCache::DefaultCapacity + files);
+    }
+}
+
+} // unnamed namespace
+
+//! \class LayoutWarmUp
+//! Parses and validates layouts and their imports concurrently, on all
+//! cores, to fill the KeyboardLoader caches before the layouts are first
+//! used. Parse errors are always reported; parse times only when
+//! MALIIT_KEYBOARD_WARMUP or MALIIT_KEYBOARD_STARTUP_TIMELINE is set.
+//!
+//! Warming up is opt-in, through the MALIIT_KEYBOARD_WARMUP environment
+//! variable: "all" (or "1") warms up every language layout, otherwise the
+//! variable is read as a comma separated list of layout ids. The layouts
+//! the user switches to next are prefetched anyway, see
+//! KeyboardLoader::prefetch().
+//!
+//! The shared layout and keyboard variant caches are enlarged to hold all
+//! warmed up layouts, and stay that large afterwards.
+
+LayoutWarmUpResult::LayoutWarmUpResult()
+    : id()
+    , elapsed_msecs(0)
+    , errors()
+{}
+
+
+bool LayoutWarmUpResult::success() const
+{
+    return errors.isEmpty();
+}
+
+
+class LayoutWarmUpPrivate
+{
+public:
+    QThreadPool pool;
+    mutable QMutex mutex;
+    QList<LayoutWarmUpResult> results;
+    int pending;
+    QElapsedTimer timer;
+    QSet<QString> ids; //!< All layouts ever warmed up.
+
+    LayoutWarmUpPrivate()
+        : pool()
+        , mutex()
+        , results()
+        , pending(0)
+        , timer()
+        , ids()
+    {}
+};
+
+
+class LayoutWarmUpJob
+    : public QRunnable
+{
+public:
+    LayoutWarmUpJob(LayoutWarmUp *warm_up,
+                    const QString &id)
+        : m_warm_up(warm_up)
+        , m_id(id)
+    {}
+
+    virtual void run()
+    {
+        LayoutWarmUpPrivate *const d(m_warm_up->d_func());
+        LayoutWarmUpResult result;
+        QElapsedTimer timer;
+
+        timer.start();
+        result.id = m_id;
+        KeyboardLoader::preload(m_id, &result.errors);
+        result.elapsed_msecs = timer.elapsed();
+
+        if (result.success()) {
+            if (reportEnabled()) {
+                qDebug() << "Warm-up:" << m_id << "loaded in" << result.elapsed_msecs << "ms";
+            }
+        } else {
+            qWarning() << "Warm-up:" << m_id << "failed after" << result.elapsed_msecs << "ms:"
+                       << result.errors;
+        }
+
+        QMutexLocker locker(&d->mutex);
+
+        d->results.append(result);
+
+        if (--d->pending == 0) {
+            QMetaObject::invokeMethod(m_warm_up, "onFinished", Qt::QueuedConnection);
+        }
+    }
+
+private:
+    LayoutWarmUp *const m_warm_up;
+    const QString m_id;
+};
+
+
+LayoutWarmUp::LayoutWarmUp(QObject *parent)
+    : QObject(parent)
+    , d_ptr(new LayoutWarmUpPrivate)
+{}
+
+
+LayoutWarmUp::~LayoutWarmUp()
+{
+    Q_D(LayoutWarmUp);
+
+    d->pool.clear();
+    d->pool.waitForDone();
+}
+
+
+//! \brief Returns the layouts to warm up, as requested through the
+//!        MALIIT_KEYBOARD_WARMUP environment variable.
+//! \param all_ids All available language layout ids.
+QStringList LayoutWarmUp::idsFromEnvironment(const QStringList &all_ids)
+{
+    const QString value(QString::fromLocal8Bit(qgetenv("MALIIT_KEYBOARD_WARMUP")).trimmed());
+
+    if (value.isEmpty() || value == "0") {
+        return QStringList();
+    }
+
+    if (value == "all" || value == "1") {
+        return all_ids;
+    }
+
+    QStringList ids;
+
+    Q_FOREACH (const QString &id, value.split(',', QString::SkipEmptyParts)) {
+        ids.append(id.trimmed());
+    }
+
+    return ids;
+}
+
+
+//! \brief Starts warming up the given layouts, one worker job per layout.
+void LayoutWarmUp::start(const QStringList &ids)
+{
+    Q_D(LayoutWarmUp);
+
+    if (ids.isEmpty()) {
+        return;
+    }
+
+    d->ids.unite(ids.toSet());
+    reserveCacheCapacity(d->ids.size());
+
+    {
+        QMutexLocker locker(&d->mutex);
+
+        if (d->pending == 0) {
+            d->results.clear();
+            d->timer.start();
+        }
+
+        d->pending += ids.size();
+    }
+
+    Q_FOREACH (const QString &id, ids) {
+        d->pool.start(new LayoutWarmUpJob(this, id));
+    }
+}
+
+
+//! \brief Blocks until all layouts are processed, or msecs passed.
+//! \returns Whether all layouts are processed.
+bool LayoutWarmUp::waitForDone(int msecs)
+{
+    Q_D(LayoutWarmUp);
+    return d->pool.waitForDone(msecs);
+}
+
+
+//! \brief Returns whether layouts are still being processed.
+bool LayoutWarmUp::isRunning() const
+{
+    Q_D(const LayoutWarmUp);
+    QMutexLocker locker(&d->mutex);
+
+    return (d->pending > 0);
+}
+
+
+//! \brief Returns the results of all processed layouts, in order of
+//!        completion.
+QList<LayoutWarmUpResult> LayoutWarmUp::results() const
+{
+    Q_D(const LayoutWarmUp);
+    QMutexLocker locker(&d->mutex);
+
+    return d->results;
+}
+
+
+void LayoutWarmUp::onFinished()
+{
+    Q_D(LayoutWarmUp);
+    int failed(0);
+    int count(0);
+
+    {
+        QMutexLocker locker(&d->mutex);
+
+        if (d->pending > 0) {
+            return;
+        }
+
+        count = d->results.size();
+        Q_FOREACH (const LayoutWarmUpResult &result, d->results) {
+            if (not result.success()) {
+                ++failed;
+            }
+        }
+    }
+
+    if (reportEnabled()) {
+        qDebug() << "Warm-up: loaded" << count << "layouts in" << d->timer.elapsed() << "ms,"
+                 << failed << "failed";
+    }
+    Q_EMIT finished();
+}
+
+} // namespace MaliitKeyboard
@@ -0,0 +1,82 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012 Openismus GmbH. All rights reserved.
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef MALIIT_KEYBOARD_LAYOUTWARMUP_H
+#define MALIIT_KEYBOARD_LAYOUTWARMUP_H
+
+#include <QtCore>
+
+namespace MaliitKeyboard {
+
+class LayoutWarmUpPrivate;
+
+//! Outcome of warming up one layout.
+struct LayoutWarmUpResult
+{
+    QString id;
+    qint64 elapsed_msecs;
+    QStringList errors;
+
+    LayoutWarmUpResult();
+    bool success() const;
+};
+
+class LayoutWarmUp
+    : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(LayoutWarmUp)
+    Q_DECLARE_PRIVATE(LayoutWarmUp)
+
+public:
+    explicit LayoutWarmUp(QObject *parent = 0);
+    virtual ~LayoutWarmUp();
+
+    static QStringList idsFromEnvironment(const QStringList &all_ids);
+
+    void start(const QStringList &ids);
+    bool waitForDone(int msecs = -1);
+    bool isRunning() const;
+    QList<LayoutWarmUpResult> results() const;
+
+    //! Emitted on the warm-up's thread once all layouts were processed.
+    Q_SIGNAL void finished();
+
+private:
+    Q_SLOT void onFinished();
+
+    friend class LayoutWarmUpJob;
+    const QScopedPointer<LayoutWarmUpPrivate> d_ptr;
+};
+
+} // namespace MaliitKeyboard
+
+#endif // MALIIT_KEYBOARD_LAYOUTWARMUP_H
@@ -2,9 +2,15 @@ LOGIC_DIR = ./logic
 
 HEADERS += \
     logic/hitlogic.h \
+    logic/keyhitindex.h \
     logic/layouthelper.h \
     logic/layoutupdater.h \
     logic/keyboardloader.h \
+    logic/keyboardbuilder.h \
+    logic/layoutcache.h \
+    logic/keyboardvariantcache.h \
+    logic/layoutwarmup.h \
+    logic/languageindex.h \
     logic/keyareaconverter.h \
     logic/style.h \
     logic/spellchecker.h \
@@ -17,9 +23,15 @@ HEADERS += \
 
 SOURCES += \
     logic/hitlogic.cpp \
+    logic/keyhitindex.cpp \
     logic/layouthelper.cpp \
     logic/layoutupdater.cpp \
     logic/keyboardloader.cpp \
+    logic/keyboardbuilder.cpp \
+    logic/layoutcache.cpp \
+    logic/keyboardvariantcache.cpp \
+    logic/layoutwarmup.cpp \
+    logic/languageindex.cpp \
     logic/keyareaconverter.cpp \
     logic/style.cpp \
     logic/spellchecker.cpp \
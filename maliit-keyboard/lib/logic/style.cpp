@@ -109,6 +109,14 @@ void Style::setProfile(const QString &profile)
             new QSettings(main_file_name, QSettings::IniFormat));
         extended_keys_attributes = new StyleAttributes(
             new QSettings(extended_keys_file_name, QSettings::IniFormat));
+
+        // Atlases are generated at build time, see atlascompiler:
+        const ImageAtlas atlas(ImageAtlas::load(g_profile_image_directory_path_format
+                                                .arg(CoreUtils::maliitKeyboardStyleProfilesDirectory())
+                                                .arg(profile)
+                                                + "/" + ImageAtlasTableFileName));
+        attributes->setImageAtlas(atlas);
+        extended_keys_attributes->setImageAtlas(atlas);
     }
 
     d->attributes.reset(attributes);
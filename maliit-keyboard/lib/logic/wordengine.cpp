@@ -103,7 +103,9 @@ std::string CandidatesCallback::get_future_stream() const
 #endif
 //! \internal_end
 
-class WordEnginePrivate
+// Loaded as a whole, on a worker thread. Presage's callback refers to the
+// candidates context, so they have to live together.
+class WordEngineBackends
 {
 public:
     SpellChecker spell_checker;
@@ -113,10 +115,10 @@ public:
     Presage presage;
 #endif
 
-    explicit WordEnginePrivate();
+    explicit WordEngineBackends();
 };
 
-WordEnginePrivate::WordEnginePrivate()
+WordEngineBackends::WordEngineBackends()
     : spell_checker()
 #ifdef HAVE_PRESAGE
     , candidates_context()
@@ -132,17 +134,97 @@ WordEnginePrivate::WordEnginePrivate()
 }
 
 
+class WordEnginePrivate
+{
+public:
+    QThreadPool pool;
+    // Written by the loader job only, read once the pool is done:
+    QScopedPointer<WordEngineBackends> backends;
+    bool backends_ready;
+
+    explicit WordEnginePrivate();
+    WordEngineBackends *waitForBackends();
+};
+
+WordEnginePrivate::WordEnginePrivate()
+    : pool()
+    , backends()
+    , backends_ready(false)
+{
+    pool.setMaxThreadCount(1);
+}
+
+
+WordEngineBackends *WordEnginePrivate::waitForBackends()
+{
+    if (not backends_ready) {
+        pool.waitForDone();
+        backends_ready = true;
+    }
+
+    return backends.data();
+}
+
+
+class WordEngineLoaderJob
+    : public QRunnable
+{
+public:
+    explicit WordEngineLoaderJob(WordEngine *engine)
+        : m_engine(engine)
+    {}
+
+    virtual void run()
+    {
+        m_engine->d_func()->backends.reset(new WordEngineBackends);
+        QMetaObject::invokeMethod(m_engine, "onBackendsLoaded", Qt::QueuedConnection);
+    }
+
+private:
+    WordEngine *const m_engine;
+};
+
+
 //! \brief Constructor.
+//!
+//! Loading Hunspell dictionaries and Presage happens on a worker thread, so
+//! that constructing the word engine does not delay the first frame. The
+//! first call that needs the backends waits for them.
 //! \param parent The owner of this instance. Can be 0, in case QObject
 //!               ownership is not required.
 WordEngine::WordEngine(QObject *parent)
     : AbstractWordEngine(parent)
     , d_ptr(new WordEnginePrivate)
-{}
+{
+    Q_D(WordEngine);
+    d->pool.start(new WordEngineLoaderJob(this));
+}
 
 //! \brief Destructor.
 WordEngine::~WordEngine()
-{}
+{
+    Q_D(WordEngine);
+    d->pool.waitForDone();
+}
+
+
+//! \brief Returns whether the backends finished loading.
+bool WordEngine::backendsLoaded() const
+{
+    Q_D(const WordEngine);
+    return d->backends_ready;
+}
+
+
+void WordEngine::onBackendsLoaded()
+{
+    Q_D(WordEngine);
+
+    if (not d->backends_ready) {
+        d->waitForBackends();
+        Q_EMIT backendsReady();
+    }
+}
 
 
 void WordEngine::setEnabled(bool enabled)
@@ -170,14 +252,15 @@ WordCandidateList WordEngine::fetchCandidates(Model::Text *text)
     return candidates;
 #else
     Q_D(WordEngine);
+    WordEngineBackends *const backends(d->waitForBackends());
 
     const QString &preedit(text->preedit());
     const bool is_preedit_capitalized(not preedit.isEmpty() && preedit.at(0).isUpper());
 
 #ifdef HAVE_PRESAGE
     const QString &context = (text->surroundingLeft() + preedit);
-    d->candidates_context = context.toStdString();
-    const std::vector<std::string> predictions = d->presage.predict();
+    backends->candidates_context = context.toStdString();
+    const std::vector<std::string> predictions = backends->presage.predict();
 
     // TODO: Fine-tune presage behaviour to also perform error correction, not just word prediction.
     if (not context.isEmpty()) {
@@ -191,10 +274,10 @@ WordCandidateList WordEngine::fetchCandidates(Model::Text *text)
     }
 #endif
 
-    const bool correct_spelling(d->spell_checker.spell(preedit));
+    const bool correct_spelling(backends->spell_checker.spell(preedit));
 
     if (candidates.isEmpty() and not correct_spelling) {
-        Q_FOREACH(const QString &correction, d->spell_checker.suggest(preedit, 5)) {
+        Q_FOREACH(const QString &correction, backends->spell_checker.suggest(preedit, 5)) {
             appendToCandidates(&candidates, WordCandidate::SourceSpellChecking, correction, is_preedit_capitalized);
         }
     }
@@ -215,7 +298,7 @@ void WordEngine::addToUserDictionary(const QString &word)
 {
     Q_D(WordEngine);
 
-    d->spell_checker.addToUserWordlist(word);
+    d->waitForBackends()->spell_checker.addToUserWordlist(word);
 }
 
 }} // namespace Logic, MaliitKeyboard
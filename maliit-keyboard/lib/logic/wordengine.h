@@ -60,11 +60,19 @@ public:
     virtual void addToUserDictionary(const QString &word);
     //! \reimp_end
 
+    bool backendsLoaded() const;
+
+    //! Emitted once Hunspell and Presage are loaded.
+    Q_SIGNAL void backendsReady();
+
 private:
     //! \reimp
     virtual WordCandidateList fetchCandidates(Model::Text *text);
     //! \reimp_end
 
+    Q_SLOT void onBackendsLoaded();
+
+    friend class WordEngineLoaderJob;
     const QScopedPointer<WordEnginePrivate> d_ptr;
 };
 
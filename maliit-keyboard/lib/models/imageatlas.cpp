@@ -0,0 +1,313 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012 Openismus GmbH. All rights reserved.
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "imageatlas.h"
+
+namespace MaliitKeyboard {
+
+//! \class ImageAtlas
+//! Coordinate table of an atlas image, which packs all images of a style
+//! profile, so that a whole keyboard can be drawn from one texture.
+//!
+//! The table is stored as INI file next to the images: the "atlas" section
+//! names the atlas image and its size, the "images" section maps each
+//! original image to its rectangle inside the atlas. Images keep their
+//! original names, so that key areas do not need to know about the atlas.
+
+const char *const ImageAtlasTableFileName = "atlas.ini";
+
+namespace {
+
+//! Orders images by decreasing height, then by decreasing width, so that
+//! rows of the atlas waste little space.
+class TallerFirst
+{
+public:
+    explicit TallerFirst(const QMap<QByteArray, QSize> &sizes)
+        : m_sizes(sizes)
+    {}
+
+    bool operator()(const QByteArray &lhs,
+                    const QByteArray &rhs) const
+    {
+        const QSize &l(m_sizes.value(lhs));
+        const QSize &r(m_sizes.value(rhs));
+
+        if (l.height() != r.height()) {
+            return l.height() > r.height();
+        }
+
+        if (l.width() != r.width()) {
+            return l.width() > r.width();
+        }
+
+        return lhs < rhs;
+    }
+
+private:
+    const QMap<QByteArray, QSize> &m_sizes;
+};
+
+int nextPowerOfTwo(int value)
+{
+    int result(1);
+
+    while (result < value) {
+        result *= 2;
+    }
+
+    return result;
+}
+
+} // namespace
+
+
+ImageAtlas::ImageAtlas()
+    : m_file_name()
+    , m_size()
+    , m_rects()
+{}
+
+
+//! \brief Returns whether the atlas has an image and any images packed.
+bool ImageAtlas::isValid() const
+{
+    return (not m_file_name.isEmpty() && not m_size.isEmpty() && not m_rects.isEmpty());
+}
+
+
+//! \brief Sets the absolute file name of the atlas image.
+void ImageAtlas::setFileName(const QString &file_name)
+{
+    m_file_name = file_name;
+}
+
+
+QString ImageAtlas::fileName() const
+{
+    return m_file_name;
+}
+
+
+void ImageAtlas::setSize(const QSize &size)
+{
+    m_size = size;
+}
+
+
+QSize ImageAtlas::size() const
+{
+    return m_size;
+}
+
+
+void ImageAtlas::setRect(const QByteArray &image,
+                         const QRect &rect)
+{
+    m_rects.insert(image, rect);
+}
+
+
+//! \brief Returns the rectangle of an image inside the atlas, or a null
+//!        rectangle if the image is not packed.
+//! \param image The base name of the original image.
+QRect ImageAtlas::rect(const QByteArray &image) const
+{
+    return m_rects.value(image);
+}
+
+
+bool ImageAtlas::contains(const QByteArray &image) const
+{
+    return m_rects.contains(image);
+}
+
+
+QList<QByteArray> ImageAtlas::images() const
+{
+    return m_rects.keys();
+}
+
+
+//! \brief Writes the coordinate table.
+//! \param table_file_name The INI file to write. The atlas image is stored
+//!                        relative to it.
+bool ImageAtlas::save(const QString &table_file_name) const
+{
+    QSettings store(table_file_name, QSettings::IniFormat);
+
+    store.clear();
+    store.setValue("atlas/image", QFileInfo(table_file_name).dir().relativeFilePath(m_file_name));
+    store.setValue("atlas/size", m_size);
+
+    store.beginGroup("images");
+
+    for (QHash<QByteArray, QRect>::const_iterator it = m_rects.constBegin();
+         it != m_rects.constEnd();
+         ++it) {
+        store.setValue(QString::fromLatin1(it.key()), it.value());
+    }
+
+    store.endGroup();
+    store.sync();
+
+    return (store.status() == QSettings::NoError);
+}
+
+
+//! \brief Reads a coordinate table. Returns an invalid atlas if the table
+//!        does not exist.
+//! \param table_file_name The INI file to read.
+ImageAtlas ImageAtlas::load(const QString &table_file_name)
+{
+    ImageAtlas atlas;
+
+    if (not QFile::exists(table_file_name)) {
+        return atlas;
+    }
+
+    const QSettings store(table_file_name, QSettings::IniFormat);
+    const QString image(store.value("atlas/image").toString());
+
+    if (image.isEmpty()) {
+        qWarning() << __PRETTY_FUNCTION__
+                   << "No atlas image given in" << table_file_name;
+        return atlas;
+    }
+
+    atlas.setFileName(QFileInfo(table_file_name).dir().absoluteFilePath(image));
+    atlas.setSize(store.value("atlas/size").toSize());
+
+    const QString prefix("images/");
+
+    Q_FOREACH (const QString &key, store.allKeys()) {
+        if (key.startsWith(prefix)) {
+            atlas.setRect(key.mid(prefix.length()).toLatin1(), store.value(key).toRect());
+        }
+    }
+
+    return atlas;
+}
+
+
+//! \brief Packs images into rows, tallest images first.
+//!
+//! The atlas is as wide as the next power of two that fits the widest image
+//! or a square of the same area. Every image is surrounded by padding, which
+//! the atlas image fills with the image's edges, so that filtering does not
+//! bleed neighbouring images into each other.
+//! \param sizes The image sizes, by image base name.
+//! \param padding The padding around each image, in pixels.
+//! \returns The atlas, without a file name.
+ImageAtlas ImageAtlas::pack(const QMap<QByteArray, QSize> &sizes,
+                            int padding)
+{
+    ImageAtlas atlas;
+    QList<QByteArray> images;
+    int widest(0);
+    qint64 area(0);
+
+    for (QMap<QByteArray, QSize>::const_iterator it = sizes.constBegin();
+         it != sizes.constEnd();
+         ++it) {
+        if (it.value().isEmpty()) {
+            continue;
+        }
+
+        const int width(it.value().width() + 2 * padding);
+        const int height(it.value().height() + 2 * padding);
+
+        images.append(it.key());
+        widest = qMax(widest, width);
+        area += qint64(width) * height;
+    }
+
+    if (images.isEmpty()) {
+        return atlas;
+    }
+
+    qSort(images.begin(), images.end(), TallerFirst(sizes));
+
+    const int width(nextPowerOfTwo(qMax(widest, qCeil(qSqrt(qreal(area))))));
+    int x(0);
+    int y(0);
+    int row_height(0);
+
+    Q_FOREACH (const QByteArray &image, images) {
+        const QSize &size(sizes.value(image));
+
+        if (x + size.width() + 2 * padding > width) {
+            x = 0;
+            y += row_height;
+            row_height = 0;
+        }
+
+        atlas.setRect(image, QRect(QPoint(x + padding, y + padding), size));
+        x += size.width() + 2 * padding;
+        row_height = qMax(row_height, size.height() + 2 * padding);
+    }
+
+    atlas.setSize(QSize(width, y + row_height));
+
+    return atlas;
+}
+
+
+bool operator==(const ImageAtlas &lhs,
+                const ImageAtlas &rhs)
+{
+    if (lhs.fileName() != rhs.fileName() || lhs.size() != rhs.size()) {
+        return false;
+    }
+
+    const QList<QByteArray> &images(lhs.images());
+
+    if (images.count() != rhs.images().count()) {
+        return false;
+    }
+
+    Q_FOREACH (const QByteArray &image, images) {
+        if (lhs.rect(image) != rhs.rect(image)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+bool operator!=(const ImageAtlas &lhs,
+                const ImageAtlas &rhs)
+{
+    return (not (lhs == rhs));
+}
+
+} // namespace MaliitKeyboard
@@ -31,29 +31,79 @@
  */
 
 #include "key.h"
+#include "keystyletable.h"
 
 namespace MaliitKeyboard {
 
+//! \class Key
+//! A key of a key area. To keep the many copies of keys made while building
+//! and rendering key areas small, a key stores its geometry as plain values
+//! and its background, font and icon as indices into the KeyStyleTable.
+//! Area and Label values are assembled on access; rArea() and rLabel()
+//! return proxies that write through to the key. Code reading a single
+//! attribute for every key, e.g. when rendering, should use background(),
+//! labelFont() etc. instead, which return references without copying.
+
 Key::Key()
     : m_origin()
-    , m_area()
-    , m_label()
+    , m_size()
+    , m_margins()
+    , m_label_rect()
+    , m_text()
+    , m_command_sequence()
+    , m_id(0)
+    , m_background(0)
+    , m_font(0)
+    , m_icon(0)
     , m_action(ActionInsert)
     , m_style(StyleNormalKey)
-    , m_margins()
-    , m_icon()
+    , m_state(KeyDescription::NormalState)
     , m_has_extended_keys(false)
+    , m_flags_padding(0)
 {}
 
 bool Key::valid() const
 {
-    return (m_area.size().isValid()
-            && (not m_label.text().isEmpty() || m_action != Key::ActionCommit));
+    return (m_size.isValid()
+            && (not m_text.isEmpty() || action() != Key::ActionCommit));
 }
 
 QRect Key::rect() const
 {
-    return QRect(m_origin, m_area.size());
+    return QRect(m_origin, m_size);
+}
+
+//! \brief Returns the key's identifier within its layout.
+//!
+//! Key area conversion assigns identifiers with idFromPosition(). Keys that
+//! were not created from a layout file have the identifier 0.
+quint16 Key::id() const
+{
+    return m_id;
+}
+
+void Key::setId(quint16 id)
+{
+    m_id = id;
+}
+
+//! \brief Returns the identifier of the key at a position of a section.
+//!
+//! The upper bits of an identifier hold the section, the lower
+//! IdPositionBits bits the position plus one. Keys of different sections
+//! thus never share an identifier.
+//! \param section The section (e.g. a symbols page) the key belongs to.
+//! \param position The position of the key within its section.
+//! \returns The identifier, or 0 if section or position is out of range.
+quint16 Key::idFromPosition(int section,
+                            int position)
+{
+    if (section < 0 || section >= (1 << (16 - IdPositionBits))
+        || position < 0 || position + 1 >= (1 << IdPositionBits)) {
+        return 0;
+    }
+
+    return static_cast<quint16>((section << IdPositionBits) | (position + 1));
 }
 
 QPoint Key::origin() const
@@ -68,37 +118,79 @@ void Key::setOrigin(const QPoint &origin)
 
 Area Key::area() const
 {
-    return m_area;
+    Area area;
+
+    area.setSize(m_size);
+    area.setBackground(KeyStyleTable::backgroundImage(m_background));
+    area.setBackgroundBorders(KeyStyleTable::backgroundBorders(m_background));
+
+    return area;
+}
+
+Key::AreaRef Key::rArea()
+{
+    return AreaRef(this);
+}
+
+const QByteArray &Key::background() const
+{
+    return KeyStyleTable::backgroundImage(m_background);
 }
 
-Area & Key::rArea()
+const QMargins &Key::backgroundBorders() const
 {
-    return m_area;
+    return KeyStyleTable::backgroundBorders(m_background);
+}
+
+//! \brief Sets background image and borders with a single table lookup.
+void Key::setBackground(const QByteArray &background,
+                        const QMargins &borders)
+{
+    m_background = KeyStyleTable::internBackground(background, borders);
 }
 
 void Key::setArea(const Area &area)
 {
-    m_area = area;
+    m_size = area.size();
+    m_background = KeyStyleTable::internBackground(area.background(), area.backgroundBorders());
 }
 
 Label Key::label() const
 {
-    return m_label;
+    Label label;
+
+    label.setText(m_text);
+    label.setFont(KeyStyleTable::font(m_font));
+    label.setRect(m_label_rect);
+
+    return label;
+}
+
+Key::LabelRef Key::rLabel()
+{
+    return LabelRef(this);
+}
+
+const QString &Key::labelText() const
+{
+    return m_text;
 }
 
-Label & Key::rLabel()
+const Font &Key::labelFont() const
 {
-    return m_label;
+    return KeyStyleTable::font(m_font);
 }
 
 void Key::setLabel(const Label &label)
 {
-    m_label = label;
+    m_text = label.text();
+    m_font = KeyStyleTable::internFont(label.font());
+    m_label_rect = label.rect();
 }
 
 Key::Action Key::action() const
 {
-    return m_action;
+    return static_cast<Action>(m_action);
 }
 
 void Key::setAction(Action action)
@@ -108,7 +200,7 @@ void Key::setAction(Action action)
 
 Key::Style Key::style() const
 {
-    return m_style;
+    return static_cast<Style>(m_style);
 }
 
 void Key::setStyle(Style style)
@@ -116,6 +208,17 @@ void Key::setStyle(Style style)
     m_style = style;
 }
 
+//! \brief Returns the visual state (normal, pressed, ...) of the key.
+KeyDescription::State Key::state() const
+{
+    return static_cast<KeyDescription::State>(m_state);
+}
+
+void Key::setState(KeyDescription::State state)
+{
+    m_state = state;
+}
+
 QMargins Key::margins() const
 {
     return m_margins;
@@ -126,14 +229,14 @@ void Key::setMargins(const QMargins &margins)
     m_margins = margins;
 }
 
-QByteArray Key::icon() const
+const QByteArray &Key::icon() const
 {
-    return m_icon;
+    return KeyStyleTable::icon(m_icon);
 }
 
 void Key::setIcon(const QByteArray &icon)
 {
-    m_icon = icon;
+    m_icon = KeyStyleTable::internIcon(icon);
 }
 
 bool Key::hasExtendedKeys() const
@@ -156,13 +259,98 @@ void Key::setCommandSequence(const QString &command_sequence)
     m_command_sequence = command_sequence;
 }
 
+Key::AreaRef::AreaRef(Key *key)
+    : m_key(key)
+{}
+
+QSize Key::AreaRef::size() const
+{
+    return m_key->m_size;
+}
+
+void Key::AreaRef::setSize(const QSize &size)
+{
+    m_key->m_size = size;
+}
+
+const QByteArray &Key::AreaRef::background() const
+{
+    return KeyStyleTable::backgroundImage(m_key->m_background);
+}
+
+void Key::AreaRef::setBackground(const QByteArray &background)
+{
+    m_key->m_background = KeyStyleTable::internBackground(background, backgroundBorders());
+}
+
+const QMargins &Key::AreaRef::backgroundBorders() const
+{
+    return KeyStyleTable::backgroundBorders(m_key->m_background);
+}
+
+void Key::AreaRef::setBackgroundBorders(const QMargins &borders)
+{
+    m_key->m_background = KeyStyleTable::internBackground(background(), borders);
+}
+
+Key::AreaRef::operator Area() const
+{
+    return m_key->area();
+}
+
+Key::LabelRef::LabelRef(Key *key)
+    : m_key(key)
+{}
+
+QString Key::LabelRef::text() const
+{
+    return m_key->m_text;
+}
+
+void Key::LabelRef::setText(const QString &text)
+{
+    m_key->m_text = text;
+}
+
+const Font &Key::LabelRef::font() const
+{
+    return KeyStyleTable::font(m_key->m_font);
+}
+
+void Key::LabelRef::setFont(const Font &font)
+{
+    m_key->m_font = KeyStyleTable::internFont(font);
+}
+
+QRect Key::LabelRef::rect() const
+{
+    return m_key->m_label_rect;
+}
+
+void Key::LabelRef::setRect(const QRect &rect)
+{
+    m_key->m_label_rect = rect;
+}
+
+Key::LabelRef::operator Label() const
+{
+    return m_key->label();
+}
+
+// Compares the members directly instead of through area() and label(),
+// which would look up the styling in the KeyStyleTable. Interned values are
+// equal if and only if their indices are.
 bool operator==(const Key &lhs,
                 const Key &rhs)
 {
-    return (lhs.origin() == rhs.origin()
-            && lhs.area() == rhs.area()
-            && lhs.label() == rhs.label()
-            && lhs.icon() == rhs.icon());
+    return (lhs.m_origin == rhs.m_origin
+            && lhs.m_size == rhs.m_size
+            && lhs.m_background == rhs.m_background
+            && lhs.m_text == rhs.m_text
+            && lhs.m_font == rhs.m_font
+            && lhs.m_label_rect == rhs.m_label_rect
+            && lhs.m_icon == rhs.m_icon
+            && lhs.m_state == rhs.m_state);
 }
 
 bool operator!=(const Key &lhs,
@@ -35,6 +35,7 @@
 
 #include "models/area.h"
 #include "models/label.h"
+#include "models/keydescription.h"
 
 #include <QtCore>
 
@@ -83,17 +84,71 @@ public:
         StyleActivated
     };
 
+    //! Gives write access to a key's area, the way a reference to an Area
+    //! member would. Setters store their value in the key right away.
+    class AreaRef
+    {
+    private:
+        Key *const m_key;
+
+    public:
+        explicit AreaRef(Key *key);
+
+        QSize size() const;
+        void setSize(const QSize &size);
+
+        const QByteArray &background() const;
+        void setBackground(const QByteArray &background);
+
+        const QMargins &backgroundBorders() const;
+        void setBackgroundBorders(const QMargins &borders);
+
+        operator Area() const;
+    };
+
+    //! Gives write access to a key's label, the way a reference to a Label
+    //! member would. Setters store their value in the key right away.
+    class LabelRef
+    {
+    private:
+        Key *const m_key;
+
+    public:
+        explicit LabelRef(Key *key);
+
+        QString text() const;
+        void setText(const QString &text);
+
+        const Font &font() const;
+        void setFont(const Font &font);
+
+        QRect rect() const;
+        void setRect(const QRect &rect);
+
+        operator Label() const;
+    };
+
 private:
+    // Geometry is kept as plain values, styling as indices into the shared
+    // KeyStyleTable.
     QPoint m_origin;
-    Area m_area;
-    Label m_label;
-    Action m_action;
-    Style m_style;
+    QSize m_size;
     QMargins m_margins;
-    QByteArray m_icon;
-    bool m_has_extended_keys: 1;
-    int m_flags_padding: 7;
+    QRect m_label_rect;
+    QString m_text;
     QString m_command_sequence;
+    quint16 m_id;
+    quint16 m_background;
+    quint16 m_font;
+    quint16 m_icon;
+    quint8 m_action;
+    quint8 m_style: 3;
+    quint8 m_state: 2;
+    quint8 m_has_extended_keys: 1;
+    quint8 m_flags_padding: 2;
+
+    friend bool operator==(const Key &lhs,
+                           const Key &rhs);
 
 public:
     explicit Key();
@@ -102,16 +157,31 @@ public:
     bool valid() const;
     QRect rect() const;
 
+    enum {
+        IdPositionBits = 11
+    };
+
+    quint16 id() const;
+    void setId(quint16 id);
+    static quint16 idFromPosition(int section,
+                                  int position);
+
     QPoint origin() const;
     void setOrigin(const QPoint &origin);
 
     Area area() const;
-    Area & rArea();
+    AreaRef rArea();
     void setArea(const Area &area);
+    const QByteArray &background() const;
+    const QMargins &backgroundBorders() const;
+    void setBackground(const QByteArray &background,
+                       const QMargins &borders);
 
     Label label() const;
-    Label & rLabel();
+    LabelRef rLabel();
     void setLabel(const Label &label);
+    const QString &labelText() const;
+    const Font &labelFont() const;
 
     Action action() const;
     void setAction(Action action);
@@ -119,10 +189,13 @@ public:
     Style style() const;
     void setStyle(Style style);
 
+    KeyDescription::State state() const;
+    void setState(KeyDescription::State state);
+
     QMargins margins() const;
     void setMargins(const QMargins &margins);
 
-    QByteArray icon() const;
+    const QByteArray &icon() const;
     void setIcon(const QByteArray &icon);
 
     bool hasExtendedKeys() const;
@@ -36,6 +36,7 @@ namespace MaliitKeyboard {
 
 KeyArea::KeyArea()
     : m_keys()
+    , m_id()
     , m_origin()
     , m_area()
 {}
@@ -50,6 +51,21 @@ QRect KeyArea::rect() const
     return QRect(m_origin, m_area.size());
 }
 
+//! \brief Returns the identifier of the layout and section the key area was
+//!        converted from.
+//!
+//! Key areas of the same identifier show the same keys in the same places,
+//! e.g. shifted or not. Empty for key areas not converted from a layout.
+QString KeyArea::id() const
+{
+    return m_id;
+}
+
+void KeyArea::setId(const QString &id)
+{
+    m_id = id;
+}
+
 QPoint KeyArea::origin() const
 {
     return m_origin;
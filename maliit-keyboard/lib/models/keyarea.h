@@ -42,6 +42,7 @@ class KeyArea
 {
 private:
     QVector<Key> m_keys;
+    QString m_id;
     QPoint m_origin;
     Area m_area;
     qreal m_margin;
@@ -52,6 +53,9 @@ public:
     bool hasKeys() const;
     QRect rect() const;
 
+    QString id() const;
+    void setId(const QString &id);
+
     QPoint origin() const;
     void setOrigin(const QPoint &origin);
 
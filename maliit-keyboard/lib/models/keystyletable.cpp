@@ -0,0 +1,295 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012 Openismus GmbH. All rights reserved.
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "keystyletable.h"
+
+namespace MaliitKeyboard {
+
+//! \class KeyStyleTable
+//! Process-wide tables of the backgrounds, fonts and icons used by keys.
+//! Keys only store 16 bit indices into these tables, so the few distinct
+//! styling values of a keyboard are kept once instead of in every key. Index
+//! 0 always refers to the empty value. Entries are never removed; a style
+//! profile has only a handful of them.
+//!
+//! All methods are thread-safe, as keyboards are also built on worker
+//! threads. Only interning takes a lock; looking up a value by its index
+//! does not, and returns a reference that stays valid for the lifetime of
+//! the process, as the model and the renderer look up the styling of every
+//! key they show.
+
+namespace {
+
+struct Background
+{
+    QByteArray image;
+    QMargins borders;
+};
+
+bool operator==(const Background &lhs,
+                const Background &rhs)
+{
+    return (lhs.image == rhs.image && lhs.borders == rhs.borders);
+}
+
+uint qHash(const Background &background)
+{
+    const QMargins &m(background.borders);
+    return (qHash(background.image) ^ static_cast<uint>(m.left() << 24 ^ m.top() << 16
+                                                         ^ m.right() << 8 ^ m.bottom()));
+}
+
+struct FontEntry
+{
+    Font font;
+};
+
+bool operator==(const FontEntry &lhs,
+                const FontEntry &rhs)
+{
+    return (lhs.font.name() == rhs.font.name()
+            && lhs.font.color() == rhs.font.color()
+            && lhs.font.size() == rhs.font.size()
+            && lhs.font.stretch() == rhs.font.stretch());
+}
+
+uint qHash(const FontEntry &entry)
+{
+    return (qHash(entry.font.name()) ^ qHash(entry.font.color())
+            ^ static_cast<uint>(entry.font.size() << 16) ^ static_cast<uint>(entry.font.stretch()));
+}
+
+// An append-only list of distinct values with a reverse index. Values are
+// stored in chunks that never move once allocated, so value() can hand out
+// references and read without taking the lock: an index is only returned by
+// intern() after its value has been stored, and count is published with
+// release semantics after that.
+template <typename T>
+class InternTable
+{
+private:
+    enum {
+        ChunkBits = 8,
+        ChunkSize = 1 << ChunkBits,
+        ChunkCount = 0x10000 / ChunkSize
+    };
+
+    QReadWriteLock m_lock;
+    QAtomicPointer<T> m_chunks[ChunkCount];
+    QAtomicInt m_count;
+    QHash<T, quint16> m_indices;
+
+public:
+    InternTable()
+        : m_lock()
+        , m_count(0)
+        , m_indices()
+    {
+        m_chunks[0].storeRelease(new T[ChunkSize]);
+        m_indices.insert(T(), 0);
+        m_count.storeRelease(1);
+    }
+
+    ~InternTable()
+    {
+        for (int chunk = 0; chunk < ChunkCount; ++chunk) {
+            delete[] m_chunks[chunk].load();
+        }
+    }
+
+    quint16 intern(const T &value)
+    {
+        {
+            QReadLocker locker(&m_lock);
+            const typename QHash<T, quint16>::const_iterator it(m_indices.constFind(value));
+
+            if (it != m_indices.constEnd()) {
+                return it.value();
+            }
+        }
+
+        QWriteLocker locker(&m_lock);
+        const typename QHash<T, quint16>::const_iterator it(m_indices.constFind(value));
+
+        if (it != m_indices.constEnd()) {
+            return it.value();
+        }
+
+        const int index(m_count.load());
+
+        if (index > 0xffff) {
+            qWarning() << __PRETTY_FUNCTION__ << "Too many distinct key styles, using the empty one.";
+            return 0;
+        }
+
+        T *chunk(m_chunks[index >> ChunkBits].load());
+
+        if (not chunk) {
+            chunk = new T[ChunkSize];
+            m_chunks[index >> ChunkBits].storeRelease(chunk);
+        }
+
+        chunk[index & (ChunkSize - 1)] = value;
+        m_indices.insert(value, index);
+        m_count.storeRelease(index + 1);
+
+        return index;
+    }
+
+    // Unknown indices refer to the empty value.
+    const T &value(quint16 index) const
+    {
+        if (index >= m_count.loadAcquire()) {
+            index = 0;
+        }
+
+        return m_chunks[index >> ChunkBits].loadAcquire()[index & (ChunkSize - 1)];
+    }
+
+    int count() const
+    {
+        return m_count.loadAcquire();
+    }
+};
+
+InternTable<Background> *backgrounds()
+{
+    static InternTable<Background> table;
+    return &table;
+}
+
+InternTable<FontEntry> *fonts()
+{
+    static InternTable<FontEntry> table;
+    return &table;
+}
+
+InternTable<QByteArray> *icons()
+{
+    static InternTable<QByteArray> table;
+    return &table;
+}
+
+} // unnamed namespace
+
+//! \brief Returns the index of a key background, adding it if needed.
+quint16 KeyStyleTable::internBackground(const QByteArray &image,
+                                        const QMargins &borders)
+{
+    Background background;
+    background.image = image;
+    background.borders = borders;
+
+    return backgrounds()->intern(background);
+}
+
+
+const QByteArray &KeyStyleTable::backgroundImage(quint16 index)
+{
+    return backgrounds()->value(index).image;
+}
+
+
+const QMargins &KeyStyleTable::backgroundBorders(quint16 index)
+{
+    return backgrounds()->value(index).borders;
+}
+
+
+//! \brief Returns the index of a label font, adding it if needed.
+quint16 KeyStyleTable::internFont(const Font &font)
+{
+    FontEntry entry;
+    entry.font = font;
+
+    return fonts()->intern(entry);
+}
+
+
+const Font &KeyStyleTable::font(quint16 index)
+{
+    return fonts()->value(index).font;
+}
+
+
+//! \brief Returns the index of an icon name, adding it if needed.
+quint16 KeyStyleTable::internIcon(const QByteArray &icon)
+{
+    return icons()->intern(icon);
+}
+
+
+const QByteArray &KeyStyleTable::icon(quint16 index)
+{
+    return icons()->value(index);
+}
+
+
+int KeyStyleTable::backgroundCount()
+{
+    return backgrounds()->count();
+}
+
+
+int KeyStyleTable::fontCount()
+{
+    return fonts()->count();
+}
+
+
+int KeyStyleTable::iconCount()
+{
+    return icons()->count();
+}
+
+
+//! \brief Returns an estimate of the memory held by all tables.
+qint64 KeyStyleTable::bytesUsed()
+{
+    qint64 bytes(0);
+
+    for (int index = 0; index < backgroundCount(); ++index) {
+        bytes += sizeof(Background) + backgroundImage(index).size();
+    }
+
+    for (int index = 0; index < fontCount(); ++index) {
+        const Font &f(font(index));
+        bytes += sizeof(FontEntry) + f.name().size() + f.color().size();
+    }
+
+    for (int index = 0; index < iconCount(); ++index) {
+        bytes += sizeof(QByteArray) + icon(index).size();
+    }
+
+    return bytes;
+}
+
+} // namespace MaliitKeyboard
@@ -36,20 +36,111 @@
 
 #include "logic/layouthelper.h"
 #include "logic/layoutupdater.h"
+#include "logic/keyhitindex.h"
 
 namespace MaliitKeyboard {
 namespace Model {
 namespace {
-QUrl toUrl(const QString &directory,
-            const QString &base_name)
+QUrl toUrl(const QString &provider,
+           const QString &directory,
+           const QString &base_name)
 {
-    if (not (directory.isEmpty() || base_name.isEmpty())) {
-        return QUrl(directory + "/" + base_name);
+    if (directory.isEmpty() || base_name.isEmpty()) {
+        return QUrl();
     }
 
-    return QUrl();
+    const QString path(directory + "/" + base_name);
 
+    if (provider.isEmpty()) {
+        return QUrl(path);
+    }
+
+    // Image providers get the absolute file name as image id, so that ids
+    // change along with the style profile:
+    QUrl url;
+    url.setScheme("image");
+    url.setHost(provider);
+    url.setPath(QDir::cleanPath(QFileInfo(path).absoluteFilePath()));
+
+    return url;
 }
+
+const Key g_empty_key;
+
+void appendRole(QVector<int> *roles,
+                int role)
+{
+    if (not roles->contains(role)) {
+        roles->append(role);
+    }
+}
+
+//! Collects the model roles that differ between two keys. Returns whether
+//! any role differs.
+bool collectChangedRoles(const Key &lhs,
+                         const Key &rhs,
+                         QVector<int> *roles)
+{
+    bool changed(false);
+
+    if (lhs.rect() != rhs.rect()) {
+        appendRole(roles, Layout::RoleKeyRectangle);
+        appendRole(roles, Layout::RoleKeyReactiveArea);
+        changed = true;
+    } else if (lhs.margins() != rhs.margins()) {
+        appendRole(roles, Layout::RoleKeyRectangle);
+        changed = true;
+    }
+    if (lhs.labelText() != rhs.labelText()) {
+        appendRole(roles, Layout::RoleKeyText);
+        changed = true;
+    }
+
+    const Font &lhs_font(lhs.labelFont());
+    const Font &rhs_font(rhs.labelFont());
+
+    if (lhs_font.name() != rhs_font.name()
+        || lhs_font.size() != rhs_font.size()
+        || lhs_font.color() != rhs_font.color()
+        || lhs_font.stretch() != rhs_font.stretch()) {
+        appendRole(roles, Layout::RoleKeyFont);
+        appendRole(roles, Layout::RoleKeyFontColor);
+        appendRole(roles, Layout::RoleKeyFontSize);
+        appendRole(roles, Layout::RoleKeyFontStretch);
+        changed = true;
+    }
+
+    if (lhs.icon() != rhs.icon()) {
+        appendRole(roles, Layout::RoleKeyIcon);
+        changed = true;
+    }
+
+    if (lhs.background() != rhs.background()) {
+        appendRole(roles, Layout::RoleKeyBackground);
+        changed = true;
+    }
+
+    if (lhs.backgroundBorders() != rhs.backgroundBorders()) {
+        appendRole(roles, Layout::RoleKeyBackgroundBorders);
+        changed = true;
+    }
+
+    return changed;
+}
+
+const int g_first_role(Layout::RoleKeyRectangle);
+const int g_role_count(Layout::RoleKeyIcon - Layout::RoleKeyRectangle + 1);
+
+//! The values of all roles of one key, as returned by Layout::data().
+struct KeyRoleData
+{
+    bool valid;
+    QVariant values[g_role_count];
+
+    KeyRoleData()
+        : valid(false)
+    {}
+};
 }
 
 
@@ -58,19 +149,36 @@ class LayoutPrivate
 public:
     QString title;
     KeyArea key_area;
+    QVector<Key> keys; //!< Shares its data with key_area, never detached.
+    QHash<int, Key> key_overrides; //!< Pressed or otherwise modified keys, by index.
+    mutable Logic::KeyHitIndex hit_index; //!< Built on first lookup.
+    mutable bool hit_index_valid;
     QString image_directory;
+    QString image_provider;
+    ImageAtlas image_atlas;
     QHash<int, QByteArray> roles;
+    mutable QVector<KeyRoleData> role_data; //!< Filled on first lookup, per key.
     qreal scaleRatio;
 
     explicit LayoutPrivate();
+    const Key & keyAt(int index) const;
+    const KeyRoleData & roleData(int index) const;
+    void invalidateRoleData();
 };
 
 
 LayoutPrivate::LayoutPrivate()
     : title()
     , key_area()
+    , keys()
+    , key_overrides()
+    , hit_index()
+    , hit_index_valid(false)
     , image_directory()
+    , image_provider()
+    , image_atlas()
     , roles()
+    , role_data()
     , scaleRatio(1)
 {
     // Model roles are used as variables in QML, hence the under_score naming
@@ -88,6 +196,74 @@ LayoutPrivate::LayoutPrivate()
 }
 
 
+//! \brief Returns the current key at index, taking per-key overrides into account.
+const Key & LayoutPrivate::keyAt(int index) const
+{
+    if (not key_overrides.isEmpty()) {
+        const QHash<int, Key>::const_iterator it(key_overrides.find(index));
+
+        if (it != key_overrides.constEnd()) {
+            return it.value();
+        }
+    }
+
+    return (index >= 0 && index < keys.count()) ? keys.at(index) : g_empty_key;
+}
+
+
+//! \brief Returns the role values of the key at index, computing them if
+//!        the key, scale ratio or image directory changed since.
+const KeyRoleData & LayoutPrivate::roleData(int index) const
+{
+    KeyRoleData &data(role_data[index]);
+
+    if (data.valid) {
+        return data;
+    }
+
+    const Key &key(keyAt(index));
+    const QRectF r(key.rect().x() * scaleRatio, key.rect().y() * scaleRatio,
+                   key.rect().width() * scaleRatio, key.rect().height() * scaleRatio);
+    const QMargins &m(key.margins());
+    const Font &font(key.labelFont());
+
+    // Neither QML nor QVariant support QMargins type. We need to transform
+    // QMargins into a QRectF so that we can abuse left, top, right, bottom
+    // (of the QRectF) *as if* it was a QMargins.
+    const QMargins &b(key.backgroundBorders());
+
+    data.values[Layout::RoleKeyReactiveArea - g_first_role] = QVariant(r);
+    data.values[Layout::RoleKeyRectangle - g_first_role]
+        = QVariant(QRectF(m.left() * scaleRatio, m.top() * scaleRatio,
+                          r.width() - (m.left() * scaleRatio + m.right() * scaleRatio),
+                          r.height() - (m.top() * scaleRatio + m.bottom() * scaleRatio)));
+    data.values[Layout::RoleKeyBackground - g_first_role]
+        = QVariant(toUrl(image_provider, image_directory, key.background()));
+    data.values[Layout::RoleKeyBackgroundBorders - g_first_role]
+        = QVariant(QRectF(b.left() * scaleRatio, b.top() * scaleRatio,
+                          b.right() * scaleRatio, b.bottom() * scaleRatio));
+    data.values[Layout::RoleKeyText - g_first_role] = QVariant(key.labelText());
+    data.values[Layout::RoleKeyFont - g_first_role] = QVariant(QString(font.name()));
+    // FIXME: QML expects QVariant(QColor(...)) here, but then we'd have a QtGui dependency, no?
+    data.values[Layout::RoleKeyFontColor - g_first_role] = QVariant(QString(font.color()));
+    // FIXME: Using qMax to suppress warning about "invalid" 0.0 font sizes in QFont::setPointSizeF.
+    data.values[Layout::RoleKeyFontSize - g_first_role] = QVariant(qMax<int>(1, font.size()));
+    data.values[Layout::RoleKeyFontStretch - g_first_role] = QVariant(font.stretch());
+    data.values[Layout::RoleKeyIcon - g_first_role] = QVariant(toUrl(image_provider, image_directory, key.icon()));
+    data.valid = true;
+
+    return data;
+}
+
+
+void LayoutPrivate::invalidateRoleData()
+{
+    for (int index = 0; index < role_data.count(); ++index) {
+        role_data[index].valid = false;
+    }
+}
+
+
 Layout::Layout(QObject *parent)
     : QAbstractListModel(parent)
     , d_ptr(new LayoutPrivate)
@@ -108,11 +284,18 @@ void Layout::setScaleRatio(qreal ratio)
         return;
     }
 
-    beginResetModel();
     d_ptr->scaleRatio = ratio;
-    endResetModel();
+    d_ptr->invalidateRoleData();
+
+    if (not d_ptr->keys.isEmpty()) {
+        QVector<int> roles;
+        roles << RoleKeyRectangle << RoleKeyReactiveArea << RoleKeyBackgroundBorders;
+        Q_EMIT dataChanged(index(0, 0), index(d_ptr->keys.count() - 1, 0), roles);
+    }
+
     Q_EMIT widthChanged(width());
     Q_EMIT heightChanged(height());
+    Q_EMIT scaleRatioChanged(ratio);
 }
 
 void Layout::setTitle(const QString &title)
@@ -133,19 +316,41 @@ QString Layout::title() const
 }
 
 
+//! \brief Sets the key area shown by this model.
+//!
+//! A key area of the same layout and section (see KeyArea::id()) is
+//! compared row by row with the current one: surplus rows are removed,
+//! missing rows are inserted and dataChanged() is emitted only for the roles
+//! that actually changed. This lets views keep their key delegates, for
+//! example when toggling shift. Any other key area resets the model.
 void Layout::setKeyArea(const KeyArea &area)
 {
-    beginResetModel();
-
     Q_D(Layout);
+
+    const QVector<Key> &keys(area.keys());
+    const int old_count(d->keys.count());
+    const int new_count(keys.count());
+
     const bool geometry_changed(d->key_area.rect() != area.rect());
     const bool background_changed(d->key_area.area().background() != area.area().background());
     const bool background_borders_changed(d->key_area.area().backgroundBorders() != area.area().backgroundBorders());
-    const bool visible_changed((d->key_area.keys().isEmpty() && not area.keys().isEmpty())
-                               || (not d->key_area.keys().isEmpty() && area.keys().isEmpty()));
+    const bool visible_changed((old_count == 0) != (new_count == 0));
     const bool origin_changed(d->key_area.origin() != area.origin());
 
-    d->key_area = area;
+    if (d->key_area.id() != area.id()) {
+        beginResetModel();
+
+        d->key_area = area;
+        d->keys = keys;
+        d->key_overrides.clear();
+        d->role_data.clear();
+        d->role_data.resize(new_count);
+        d->hit_index_valid = false;
+
+        endResetModel();
+    } else {
+        updateKeyArea(area);
+    }
 
     if (origin_changed) {
         Q_EMIT originChanged(d->key_area.origin());
@@ -165,33 +370,160 @@ void Layout::setKeyArea(const KeyArea &area)
     }
 
     if (visible_changed) {
-        Q_EMIT visibleChanged(not d->key_area.keys().isEmpty());
+        Q_EMIT visibleChanged(not d->keys.isEmpty());
+    }
+}
+
+
+//! \brief Diffs the key area with the current one, see setKeyArea().
+void Layout::updateKeyArea(const KeyArea &area)
+{
+    Q_D(Layout);
+
+    const QVector<Key> &keys(area.keys());
+    const int old_count(d->keys.count());
+    const int new_count(keys.count());
+
+    QVector<int> roles;
+    QVector<int> changed_rows;
+    int first_changed(-1);
+    int last_changed(-1);
+
+    for (int index = 0; index < qMin(old_count, new_count); ++index) {
+        if (collectChangedRoles(d->keyAt(index), keys.at(index), &roles)) {
+            changed_rows.append(index);
+
+            if (first_changed < 0) {
+                first_changed = index;
+            }
+
+            last_changed = index;
+        }
     }
 
-    endResetModel();
+    if (new_count < old_count) {
+        beginRemoveRows(QModelIndex(), new_count, old_count - 1);
+    } else if (new_count > old_count) {
+        beginInsertRows(QModelIndex(), old_count, new_count - 1);
+    }
+
+    d->key_area = area;
+    d->keys = keys;
+    d->key_overrides.clear();
+
+    // Rows that are new or changed get their role data recomputed on next
+    // lookup, all others keep it:
+    d->role_data.resize(new_count);
+
+    Q_FOREACH (int row, changed_rows) {
+        d->role_data[row].valid = false;
+    }
+
+    if (new_count != old_count || roles.contains(RoleKeyReactiveArea)) {
+        d->hit_index_valid = false;
+    }
+
+    if (new_count < old_count) {
+        endRemoveRows();
+    } else if (new_count > old_count) {
+        endInsertRows();
+    }
+
+    if (first_changed >= 0) {
+        Q_EMIT dataChanged(index(first_changed, 0), index(last_changed, 0), roles);
+    }
 }
 
 
+//! \brief Returns the key area, including any replaced keys.
+//!
+//! Only detaches from the shared key area while keys are replaced; use key()
+//! for single key lookups instead.
 KeyArea Layout::keyArea() const
 {
     Q_D(const Layout);
-    return d->key_area;
+
+    if (d->key_overrides.isEmpty()) {
+        return d->key_area;
+    }
+
+    KeyArea area(d->key_area);
+    QVector<Key> &keys(area.rKeys());
+
+    for (QHash<int, Key>::const_iterator it = d->key_overrides.constBegin();
+         it != d->key_overrides.constEnd();
+         ++it) {
+        keys.replace(it.key(), it.value());
+    }
+
+    return area;
+}
+
+
+//! \brief Returns the current key at index, or an invalid key.
+Key Layout::key(int index) const
+{
+    Q_D(const Layout);
+    return d->keyAt(index);
+}
+
+
+//! \brief Returns the index of the key whose reactive area contains pos, or -1.
+//! \param pos The position, in the same (scaled) coordinates as the
+//!            key_reactive_area role.
+int Layout::keyIndexAt(const QPointF &pos) const
+{
+    Q_D(const Layout);
+
+    if (not d->hit_index_valid) {
+        d->hit_index.build(d->keys);
+        d->hit_index_valid = true;
+    }
+
+    return d->hit_index.keyAt(QPoint(qFloor(pos.x() / d->scaleRatio),
+                                     qFloor(pos.y() / d->scaleRatio)));
 }
 
 
+//! \brief Replaces the key at index, without copying the shared key area.
+//!
+//! Replaced keys are kept in a sparse per-key overlay. Replacing a key with
+//! its original version removes it from the overlay again.
 void Layout::replaceKey(int index,
                         const Key &key)
 {
     Q_D(Layout);
-    d->key_area.rKeys().replace(index, key);
-    Q_EMIT dataChanged(this->index(index, 0), this->index(index, 0));
+
+    if (index < 0 || index >= d->keys.count()) {
+        qWarning() << __PRETTY_FUNCTION__
+                   << "Invalid index:" << index
+                   << "Keys available:" << d->keys.count();
+        return;
+    }
+
+    QVector<int> roles;
+    const bool changed(collectChangedRoles(d->keyAt(index), key, &roles));
+
+    if (d->keys.at(index) == key) {
+        if (d->key_overrides.remove(index) == 0) {
+            return;
+        }
+    } else {
+        d->key_overrides.insert(index, key);
+    }
+
+    // Keys differing only in e.g. their state look the same:
+    if (changed) {
+        d->role_data[index].valid = false;
+        Q_EMIT dataChanged(this->index(index, 0), this->index(index, 0), roles);
+    }
 }
 
 
 bool Layout::isVisible() const
 {
     Q_D(const Layout);
-    return (not d->key_area.keys().isEmpty());
+    return (not d->keys.isEmpty());
 }
 
 
@@ -219,7 +551,7 @@ QPoint Layout::origin() const
 QUrl Layout::background() const
 {
     Q_D(const Layout);
-    return toUrl(d->image_directory, d->key_area.area().background());
+    return toUrl(d->image_provider, d->image_directory, d->key_area.area().background());
 }
 
 
@@ -238,77 +570,94 @@ void Layout::setImageDirectory(const QString &directory)
 
     if (d->image_directory != directory) {
         d->image_directory = directory;
-        // TODO: Make sure we don't accidentially invalidate the whole model twice
-        beginResetModel();
-        backgroundChanged(background());
-        endResetModel();
+        updateImageUrls();
     }
 }
 
 
-int Layout::rowCount(const QModelIndex &parent) const
+QString Layout::imageDirectory() const
 {
-    Q_UNUSED(parent)
     Q_D(const Layout);
-    return d->key_area.keys().count();
+    return d->image_directory;
 }
 
 
-QVariant Layout::data(const QModelIndex &index,
-                      int role) const
+//! \brief Makes image roles refer to images through a QQuickImageProvider.
+//! \param provider The id the image provider was registered with, or an
+//!                 empty string for plain file URLs.
+void Layout::setImageProvider(const QString &provider)
 {
-    Q_D(const Layout);
+    Q_D(Layout);
+
+    if (d->image_provider != provider) {
+        d->image_provider = provider;
+        updateImageUrls();
+    }
+}
 
-    const QVector<Key> &keys(d->key_area.keys());
-    const Key &key(index.row() < keys.count()
-                   ? keys.at(index.row())
-                   : Key());
 
-    switch(role) {
-    case RoleKeyReactiveArea:
-        return QVariant(QRectF(key.rect().x() * d->scaleRatio, key.rect().y() * d->scaleRatio,
-                               key.rect().width() * d->scaleRatio, key.rect().height() * d->scaleRatio));
+QString Layout::imageProvider() const
+{
+    Q_D(const Layout);
+    return d->image_provider;
+}
 
-    case RoleKeyRectangle: {
-        const QRectF &r = QRectF(key.rect().x() * d->scaleRatio, key.rect().y() * d->scaleRatio,
-                       key.rect().width() * d->scaleRatio, key.rect().height() * d->scaleRatio);
-        const QMargins &m(key.margins());
 
-        return QVariant(QRectF(m.left() * d->scaleRatio, m.top() * d->scaleRatio,
-                               r.width() - (m.left() * d->scaleRatio + m.right() * d->scaleRatio),
-                               r.height() - (m.top() * d->scaleRatio + m.bottom() * d->scaleRatio)));
+//! \brief Sets the atlas packing the images of the active style, for
+//!        renderers that draw all keys from one texture.
+void Layout::setImageAtlas(const ImageAtlas &atlas)
+{
+    Q_D(Layout);
+
+    if (d->image_atlas != atlas) {
+        d->image_atlas = atlas;
+        Q_EMIT imageAtlasChanged();
     }
+}
+
 
-    case RoleKeyBackground:
-        return QVariant(toUrl(d->image_directory, key.area().background()));
+const ImageAtlas & Layout::imageAtlas() const
+{
+    Q_D(const Layout);
+    return d->image_atlas;
+}
 
-    case RoleKeyBackgroundBorders: {
-        // Neither QML nor QVariant support QMargins type.
-        // We need to transform QMargins into a QRectF so that we can abuse
-        // left, top, right, bottom (of the QRectF) *as if* it was a QMargins.
-        const QMargins &m(key.area().backgroundBorders());
-        return QVariant(QRectF(m.left() * d->scaleRatio, m.top() * d->scaleRatio, m.right() * d->scaleRatio, m.bottom() * d->scaleRatio));
+
+void Layout::updateImageUrls()
+{
+    Q_D(Layout);
+
+    d->invalidateRoleData();
+    Q_EMIT backgroundChanged(background());
+
+    if (not d->keys.isEmpty()) {
+        QVector<int> roles;
+        roles << RoleKeyBackground << RoleKeyIcon;
+        Q_EMIT dataChanged(index(0, 0), index(d->keys.count() - 1, 0), roles);
     }
+}
 
-    case RoleKeyText:
-        return QVariant(key.label().text());
 
-    case RoleKeyFont:
-        return QVariant(QString(key.label().font().name()));
+int Layout::rowCount(const QModelIndex &parent) const
+{
+    Q_UNUSED(parent)
+    Q_D(const Layout);
+    return d->keys.count();
+}
 
-    case RoleKeyFontColor:
-        // FIXME: QML expects QVariant(QColor(...)) here, but then we'd have a QtGui dependency, no?
-        return QVariant(QString(key.label().font().color()));
 
-    case RoleKeyFontSize:
-        // FIXME: Using qMax to suppress warning about "invalid" 0.0 font sizes in QFont::setPointSizeF.
-        return QVariant(qMax<int>(1, key.label().font().size()));
+//! \brief Returns the value of a role, as computed once per key, scale
+//!        ratio and image directory.
+QVariant Layout::data(const QModelIndex &index,
+                      int role) const
+{
+    Q_D(const Layout);
 
-    case RoleKeyFontStretch:
-        return QVariant(key.label().font().stretch());
+    const int row(index.row());
 
-    case RoleKeyIcon:
-        return QVariant(toUrl(d->image_directory, key.icon()));
+    if (row >= 0 && row < d->keys.count()
+        && role >= g_first_role && role < g_first_role + g_role_count) {
+        return d->roleData(row).values[role - g_first_role];
     }
 
     qWarning() << __PRETTY_FUNCTION__
@@ -33,6 +33,7 @@
 #define MALIIT_KEYBOARD_LAYOUT_H
 
 #include "models/key.h"
+#include "models/imageatlas.h"
 #include <QtCore>
 
 namespace MaliitKeyboard {
@@ -73,6 +74,8 @@ class Layout
                                NOTIFY backgroundChanged)
     Q_PROPERTY(QRectF background_borders READ backgroundBorders
                                          NOTIFY backgroundBordersChanged)
+    Q_PROPERTY(qreal scale_ratio READ scaleRatio
+                                 NOTIFY scaleRatioChanged)
 
 public:
     enum Roles {
@@ -98,6 +101,8 @@ public:
     Q_SLOT void setKeyArea(const KeyArea &area);
     KeyArea keyArea() const;
 
+    Key key(int index) const;
+    int keyIndexAt(const QPointF &pos) const;
     void replaceKey(int index,
                     const Key &key);
 
@@ -112,6 +117,7 @@ public:
 
     qreal scaleRatio() const;
     void setScaleRatio(qreal ratio);
+    Q_SIGNAL void scaleRatioChanged(qreal changed);
 
     Q_SLOT QPoint origin() const;
     Q_SIGNAL void originChanged(const QPoint &changed);
@@ -124,6 +130,13 @@ public:
 
     // FIXME: Turn into class variable?
     Q_SLOT void setImageDirectory(const QString &directory);
+    QString imageDirectory() const;
+    void setImageProvider(const QString &provider);
+    QString imageProvider() const;
+
+    void setImageAtlas(const ImageAtlas &atlas);
+    const ImageAtlas & imageAtlas() const;
+    Q_SIGNAL void imageAtlasChanged();
 
     virtual QHash<int, QByteArray> roleNames() const;
     virtual int rowCount(const QModelIndex &parent = QModelIndex()) const;
@@ -134,6 +147,9 @@ public:
                               const QString &role) const;
 
 private:
+    void updateKeyArea(const KeyArea &area);
+    void updateImageUrls();
+
     const QScopedPointer<LayoutPrivate> d_ptr;
 };
 
@@ -5,6 +5,7 @@ HEADERS += \
     models/font.h \
     models/label.h \
     models/key.h \
+    models/keystyletable.h \
     models/keyarea.h \
     models/layout.h \
     models/keyboard.h \
@@ -13,17 +14,20 @@ HEADERS += \
     models/wordribbon.h \
     models/text.h \
     models/styleattributes.h \
+    models/imageatlas.h \
 
 SOURCES += \
     models/area.cpp \
     models/font.cpp \
     models/label.cpp \
     models/key.cpp \
+    models/keystyletable.cpp \
     models/keyarea.cpp \
     models/layout.cpp \
     models/wordcandidate.cpp \
     models/wordribbon.cpp \
     models/text.cpp \
     models/styleattributes.cpp \
+    models/imageatlas.cpp \
 
 DEPENDPATH += $$MODELS_DIR
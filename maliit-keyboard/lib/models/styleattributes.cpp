@@ -35,6 +35,11 @@
 //! \class StyleAttributes
 //! This class allows to query style attributes, such as image names and font
 //! sizes. Styling attributes are read from INI files.
+//!
+//! The INI file is only read once, when the instance is created. All values
+//! are resolved into typed tables per style name and orientation then,
+//! including the fallback to the 'default' section, so that getters do not
+//! need to build keys or query the settings store.
 
 namespace MaliitKeyboard {
 namespace {
@@ -186,18 +191,164 @@ QVariant lookup(const QScopedPointer<const QSettings> &store,
     return result;
 }
 
+const int NumKeyWidths = KeyDescription::Stretched + 1;
+const int NumKeyStyles = Key::StyleActivated + 1;
+const int NumKeyStates = KeyDescription::HighlightedState + 1;
+const int NumKeyIcons = KeyDescription::CustomIcon + 1;
+const int NumOrientations = 2;
+
+int orientationIndex(Logic::LayoutHelper::Orientation orientation)
+{
+    return (orientation == Logic::LayoutHelper::Landscape ? 0 : 1);
+}
+
+Logic::LayoutHelper::Orientation orientationFromIndex(int index)
+{
+    return (index == 0 ? Logic::LayoutHelper::Landscape : Logic::LayoutHelper::Portrait);
+}
+
+QByteArray metricsKey(const QString &style_name,
+                      int orientation_index)
+{
+    return (style_name.toLocal8Bit() + '/' + QByteArray::number(orientation_index));
+}
+
 } // namespace
 
 
+//! All attributes depending on style name and orientation.
+struct StyleAttributes::Metrics
+{
+    QByteArray font_name;
+    QByteArray font_color;
+    qreal font_size;
+    qreal small_font_size;
+    qreal candidate_font_size;
+    qreal magnifier_font_size;
+    qreal candidate_font_stretch;
+    qreal word_ribbon_height;
+    qreal magnifier_key_height;
+    qreal key_height;
+    qreal key_top_row_height;
+    qreal key_bottom_row_height;
+    qreal magnifier_key_width;
+    qreal key_widths[NumKeyWidths];
+    qreal key_area_width;
+    qreal key_margin;
+    qreal key_area_padding;
+    qreal vertical_offset;
+    qreal magnifier_key_label_vertical_offset;
+    qreal safety_margin;
+
+    Metrics(const QScopedPointer<const QSettings> &store,
+            Logic::LayoutHelper::Orientation orientation,
+            const QByteArray &style_name)
+        : font_name(lookup(store, orientation, style_name, "font-name").toByteArray())
+        , font_color(lookup(store, orientation, style_name, "font-color").toByteArray())
+        , font_size(lookup(store, orientation, style_name, "font-size").toReal())
+        , small_font_size(lookup(store, orientation, style_name, "small-font-size").toReal())
+        , candidate_font_size(lookup(store, orientation, style_name, "candidate-font-size").toReal())
+        , magnifier_font_size(lookup(store, orientation, style_name, "magnifier-font-size").toReal())
+        , candidate_font_stretch(lookup(store, orientation, style_name, "candidate-font-stretch").toReal())
+        , word_ribbon_height(lookup(store, orientation, style_name, "word-ribbon-height").toReal())
+        , magnifier_key_height(lookup(store, orientation, style_name, "magnifier-key-height").toReal())
+        , key_height(lookup(store, orientation, style_name, "key-height").toReal())
+        , key_top_row_height(lookup(store, orientation, style_name, "key-top-row-height").toReal())
+        , key_bottom_row_height(lookup(store, orientation, style_name, "key-bottom-row-height").toReal())
+        , magnifier_key_width(lookup(store, orientation, style_name, "magnifier-key-width").toReal())
+        , key_area_width(lookup(store, orientation, style_name, "key-area-width").toReal())
+        , key_margin(lookup(store, orientation, style_name, "key-margins").toReal())
+        , key_area_padding(lookup(store, orientation, style_name, "key-area-paddings").toReal())
+        , vertical_offset(lookup(store, orientation, style_name, "vertical-offset").toReal())
+        , magnifier_key_label_vertical_offset(lookup(store, orientation, style_name,
+                                                     "magnifier-key-label-vertical-offset").toReal())
+        , safety_margin(lookup(store, orientation, style_name, "safety-margin").toReal())
+    {
+        if (font_name.isEmpty()) {
+            font_name = "Nokia Pure";
+        }
+
+        for (int width = 0; width < NumKeyWidths; ++width) {
+            key_widths[width] = lookup(store, orientation, style_name,
+                                       QByteArray("key-width").append(fromKeyWidth(static_cast<KeyDescription::Width>(width)))).toReal();
+        }
+    }
+};
+
+
 //! @param store The settings store which is used to look up all attributes.
 //!              Must not be null. StyleAttribute instance takes ownership.
 StyleAttributes::StyleAttributes(const QSettings *store)
-    : m_store(store)
-    , m_style_name()
+    : m_style_name()
+    , m_metrics()
+    , m_key_backgrounds(NumKeyStyles * NumKeyStates)
+    , m_icons(NumKeyIcons * NumKeyStates)
 {
-    if (m_store.isNull()) {
+    const QScopedPointer<const QSettings> owned_store(store);
+
+    if (owned_store.isNull()) {
         qFatal("QSettings store cannot be null!");
     }
+
+    m_word_ribbon_background = store->value("background/word-ribbon").toByteArray();
+    m_key_area_background = store->value("background/key-area").toByteArray();
+    m_magnifier_key_background = store->value("background/magnifier-key").toByteArray();
+    m_word_ribbon_background_borders = fromByteArray(store->value("background/word-ribbon-borders").toByteArray());
+    m_key_area_background_borders = fromByteArray(store->value("background/key-area-borders").toByteArray());
+    m_magnifier_key_background_borders = fromByteArray(store->value("background/magnifier-key-borders").toByteArray());
+    m_key_background_borders = fromByteArray(store->value("background/key-borders").toByteArray());
+    m_font_files = store->value("font/font-files").toStringList();
+    m_key_press_sound = store->value("sound/key-press").toByteArray();
+    m_key_release_sound = store->value("sound/key-release").toByteArray();
+    m_layout_change_sound = store->value("sound/layout-change").toByteArray();
+    m_keyboard_hide_sound = store->value("sound/keyboard-hide").toByteArray();
+
+    for (int state = 0; state < NumKeyStates; ++state) {
+        const QByteArray state_suffix(fromKeyState(static_cast<KeyDescription::State>(state)));
+
+        for (int style = 0; style < NumKeyStyles; ++style) {
+            KeyBackground &background(m_key_backgrounds[style * NumKeyStates + state]);
+
+            background.image = store->value(QByteArray("background/")
+                                            + fromKeyStyle(static_cast<Key::Style>(style))
+                                            + state_suffix).toByteArray();
+            background.borders = m_key_background_borders;
+        }
+
+        for (int icon = 0; icon < NumKeyIcons; ++icon) {
+            m_icons[icon * NumKeyStates + state]
+                = store->value(QByteArray("icon/")
+                               + fromKeyIcon(static_cast<KeyDescription::Icon>(icon))
+                               + state_suffix).toByteArray();
+        }
+    }
+
+    // Style sections are the ones having orientation sub sections; all of
+    // them are resolved, including the 'default' one used for unknown
+    // style names.
+    QSet<QString> style_names;
+    style_names.insert("default");
+
+    Q_FOREACH (const QString &key, store->allKeys()) {
+        const QStringList parts(key.split('/'));
+
+        if (parts.size() == 3
+            && (parts.at(1) == QLatin1String("landscape") || parts.at(1) == QLatin1String("portrait"))) {
+            style_names.insert(parts.first());
+        } else if (parts.size() == 2 && parts.first() == QLatin1String("icon")) {
+            m_custom_icons.insert(parts.at(1).toUtf8(), store->value(key).toByteArray());
+        }
+    }
+
+    Q_FOREACH (const QString &style_name, style_names) {
+        for (int index = 0; index < NumOrientations; ++index) {
+            m_metrics.insert(metricsKey(style_name, index),
+                             SharedMetrics(new Metrics(owned_store, orientationFromIndex(index),
+                                                       style_name.toLocal8Bit())));
+        }
+    }
+
+    setStyleName(QString());
 }
 
 //! \brief Destructor
@@ -220,13 +371,29 @@ StyleAttributes::~StyleAttributes()
 void StyleAttributes::setStyleName(const QString &name)
 {
     m_style_name = name;
+
+    for (int index = 0; index < NumOrientations; ++index) {
+        SharedMetrics metrics(m_metrics.value(metricsKey(name, index)));
+
+        if (not metrics) {
+            metrics = m_metrics.value(metricsKey("default", index));
+        }
+
+        m_active_metrics[index] = metrics.data();
+    }
+}
+
+//! \brief Returns the style name set by setStyleName().
+QString StyleAttributes::styleName() const
+{
+    return m_style_name;
 }
 
 //! \brief Looks up the background image name for word ribbons.
 //! @returns Value of "background\word-ribbon".
 QByteArray StyleAttributes::wordRibbonBackground() const
 {
-    return m_store->value("background/word-ribbon").toByteArray();
+    return m_word_ribbon_background;
 }
 
 
@@ -234,7 +401,7 @@ QByteArray StyleAttributes::wordRibbonBackground() const
 //! @returns Value of "background\key-area".
 QByteArray StyleAttributes::keyAreaBackground() const
 {
-    return m_store->value("background/key-area").toByteArray();
+    return m_key_area_background;
 }
 
 
@@ -242,7 +409,7 @@ QByteArray StyleAttributes::keyAreaBackground() const
 //! @returns Value of "background\magnifier-key"
 QByteArray StyleAttributes::magnifierKeyBackground() const
 {
-    return m_store->value("background/magnifier-key").toByteArray();
+    return m_magnifier_key_background;
 }
 
 
@@ -254,11 +421,21 @@ QByteArray StyleAttributes::magnifierKeyBackground() const
 QByteArray StyleAttributes::keyBackground(Key::Style style,
                                           KeyDescription::State state) const
 {
-    QByteArray key("background/");
-    key.append(fromKeyStyle(style));
-    key.append(fromKeyState(state));
+    return m_key_backgrounds.at(style * NumKeyStates + state).image;
+}
+
 
-    return m_store->value(key).toByteArray();
+//! \brief Returns background image and borders for keys, depending on style
+//!        and state.
+//!
+//! The returned entry stays valid as long as this instance exists, so
+//! applying it to a key does not need to allocate.
+//! @param style The key style (normal, special, deadkey).
+//! @param state The key state (normal, pressed, disabled, highlighted).
+const KeyBackground & StyleAttributes::keyStateBackground(Key::Style style,
+                                                          KeyDescription::State state) const
+{
+    return m_key_backgrounds.at(style * NumKeyStates + state);
 }
 
 
@@ -266,7 +443,7 @@ QByteArray StyleAttributes::keyBackground(Key::Style style,
 //! @returns Value of "background\word-ribbon-borders".
 QMargins StyleAttributes::wordRibbonBackgroundBorders() const
 {
-    return fromByteArray(m_store->value("background/word-ribbon-borders").toByteArray());
+    return m_word_ribbon_background_borders;
 }
 
 
@@ -274,7 +451,7 @@ QMargins StyleAttributes::wordRibbonBackgroundBorders() const
 //! @returns Value of "background\key-area-borders".
 QMargins StyleAttributes::keyAreaBackgroundBorders() const
 {
-    return fromByteArray(m_store->value("background/key-area-borders").toByteArray());
+    return m_key_area_background_borders;
 }
 
 
@@ -282,7 +459,7 @@ QMargins StyleAttributes::keyAreaBackgroundBorders() const
 //! @returns Value of "background\magnifier-key-borders".
 QMargins StyleAttributes::magnifierKeyBackgroundBorders() const
 {
-    return fromByteArray(m_store->value("background/magnifier-key-borders").toByteArray());
+    return m_magnifier_key_background_borders;
 }
 
 
@@ -290,7 +467,7 @@ QMargins StyleAttributes::magnifierKeyBackgroundBorders() const
 //! @returns Value of "background\key-borders".
 QMargins StyleAttributes::keyBackgroundBorders() const
 {
-    return fromByteArray(m_store->value("background/key-borders").toByteArray());
+    return m_key_background_borders;
 }
 
 
@@ -301,11 +478,7 @@ QMargins StyleAttributes::keyBackgroundBorders() const
 QByteArray StyleAttributes::icon(KeyDescription::Icon icon,
                                  KeyDescription::State state) const
 {
-    QByteArray key("icon/");
-    key.append(fromKeyIcon(icon));
-    key.append(fromKeyState(state));
-
-    return m_store->value(key).toByteArray();
+    return m_icons.at(icon * NumKeyStates + state);
 }
 
 
@@ -314,10 +487,7 @@ QByteArray StyleAttributes::icon(KeyDescription::Icon icon,
 //! \returns Value of "icon\${icon_name}".
 QByteArray StyleAttributes::customIcon(const QString &icon_name) const
 {
-    QByteArray key("icon/");
-    key.append(icon_name.toUtf8());
-
-    return m_store->value(key).toByteArray();
+    return m_custom_icons.value(icon_name.toUtf8());
 }
 
 
@@ -327,15 +497,7 @@ QByteArray StyleAttributes::customIcon(const QString &icon_name) const
 //! Pure" if there was no such value in style.ini.
 QByteArray StyleAttributes::fontName(Logic::LayoutHelper::Orientation orientation) const
 {
-    const QByteArray font_name(lookup(m_store, orientation,
-                                      m_style_name.toLocal8Bit(),
-                                      QByteArray("font-name")).toByteArray());
-
-    if (font_name.isEmpty()) {
-        return "Nokia Pure";
-    }
-
-    return font_name;
+    return m_active_metrics[orientationIndex(orientation)]->font_name;
 }
 
 
@@ -344,7 +506,22 @@ QByteArray StyleAttributes::fontName(Logic::LayoutHelper::Orientation orientatio
 //! \returns Value of "font\font-files"
 QStringList StyleAttributes::fontFiles() const
 {
-    return m_store->value("font/font-files").toStringList();
+    return m_font_files;
+}
+
+
+//! \brief Sets the atlas that packs the images of this style.
+void StyleAttributes::setImageAtlas(const ImageAtlas &atlas)
+{
+    m_image_atlas = atlas;
+}
+
+
+//! \brief Returns the atlas that packs the images of this style, or an
+//!        invalid atlas if the style ships none.
+const ImageAtlas & StyleAttributes::imageAtlas() const
+{
+    return m_image_atlas;
 }
 
 
@@ -353,9 +530,7 @@ QStringList StyleAttributes::fontFiles() const
 //! @returns Value of "${style}\${orientation}\font-color".
 QByteArray StyleAttributes::fontColor(Logic::LayoutHelper::Orientation orientation) const
 {
-    return lookup(m_store, orientation,
-                  m_style_name.toLocal8Bit(),
-                  QByteArray("font-color")).toByteArray();
+    return m_active_metrics[orientationIndex(orientation)]->font_color;
 }
 
 
@@ -364,9 +539,7 @@ QByteArray StyleAttributes::fontColor(Logic::LayoutHelper::Orientation orientati
 //! @returns Value of "${style}\${orientation}\font-size".
 qreal StyleAttributes::fontSize(Logic::LayoutHelper::Orientation orientation) const
 {
-    return lookup(m_store, orientation,
-                  m_style_name.toLocal8Bit(),
-                  QByteArray("font-size")).toReal();
+    return m_active_metrics[orientationIndex(orientation)]->font_size;
 }
 
 
@@ -375,9 +548,7 @@ qreal StyleAttributes::fontSize(Logic::LayoutHelper::Orientation orientation) co
 //! @returns Value of "${style}\${orientation}\small-font-size".
 qreal StyleAttributes::smallFontSize(Logic::LayoutHelper::Orientation orientation) const
 {
-    return lookup(m_store, orientation,
-                  m_style_name.toLocal8Bit(),
-                  QByteArray("small-font-size")).toReal();
+    return m_active_metrics[orientationIndex(orientation)]->small_font_size;
 }
 
 
@@ -386,9 +557,7 @@ qreal StyleAttributes::smallFontSize(Logic::LayoutHelper::Orientation orientatio
 //! @returns Value of "${style}\${orientation}\candidates-font-size".
 qreal StyleAttributes::candidateFontSize(Logic::LayoutHelper::Orientation orientation) const
 {
-    return lookup(m_store, orientation,
-                  m_style_name.toLocal8Bit(),
-                  QByteArray("candidate-font-size")).toReal();
+    return m_active_metrics[orientationIndex(orientation)]->candidate_font_size;
 }
 
 
@@ -397,9 +566,7 @@ qreal StyleAttributes::candidateFontSize(Logic::LayoutHelper::Orientation orient
 //! @returns Value of "${style}\${orientation}\magnifier-font-size".
 qreal StyleAttributes::magnifierFontSize(Logic::LayoutHelper::Orientation orientation) const
 {
-    return lookup(m_store, orientation,
-                  m_style_name.toLocal8Bit(),
-                  QByteArray("magnifier-font-size")).toReal();
+    return m_active_metrics[orientationIndex(orientation)]->magnifier_font_size;
 }
 
 
@@ -412,9 +579,7 @@ qreal StyleAttributes::magnifierFontSize(Logic::LayoutHelper::Orientation orient
 //! @returns Value of "${style}\${orientation}\candidate-font-stretch".
 qreal StyleAttributes::candidateFontStretch(Logic::LayoutHelper::Orientation orientation) const
 {
-    return lookup(m_store, orientation,
-                  m_style_name.toLocal8Bit(),
-                  QByteArray("candidate-font-stretch")).toReal();
+    return m_active_metrics[orientationIndex(orientation)]->candidate_font_stretch;
 }
 
 
@@ -423,9 +588,7 @@ qreal StyleAttributes::candidateFontStretch(Logic::LayoutHelper::Orientation ori
 //! @returns Value of "${style}\${orientation}\word-ribbon-height".
 qreal StyleAttributes::wordRibbonHeight(Logic::LayoutHelper::Orientation orientation) const
 {
-    return lookup(m_store, orientation,
-                  m_style_name.toLocal8Bit(),
-                  QByteArray("word-ribbon-height")).toReal();
+    return m_active_metrics[orientationIndex(orientation)]->word_ribbon_height;
 }
 
 
@@ -434,9 +597,7 @@ qreal StyleAttributes::wordRibbonHeight(Logic::LayoutHelper::Orientation orienta
 //! @returns Value of "${style}\${orientation}\magnifier-key-height".
 qreal StyleAttributes::magnifierKeyHeight(Logic::LayoutHelper::Orientation orientation) const
 {
-    return lookup(m_store, orientation,
-                  m_style_name.toLocal8Bit(),
-                  QByteArray("magnifier-key-height")).toReal();
+    return m_active_metrics[orientationIndex(orientation)]->magnifier_key_height;
 }
 
 
@@ -445,9 +606,7 @@ qreal StyleAttributes::magnifierKeyHeight(Logic::LayoutHelper::Orientation orien
 //! @returns Value of "${style}\${orientation}\key-height".
 qreal StyleAttributes::keyHeight(Logic::LayoutHelper::Orientation orientation) const
 {
-    return lookup(m_store, orientation,
-                  m_style_name.toLocal8Bit(),
-                  QByteArray("key-height")).toReal();
+    return m_active_metrics[orientationIndex(orientation)]->key_height;
 }
 
 
@@ -456,9 +615,7 @@ qreal StyleAttributes::keyHeight(Logic::LayoutHelper::Orientation orientation) c
 //! @returns Value of "${style}\${orientation}\key-height".
 qreal StyleAttributes::keyTopRowHeight(Logic::LayoutHelper::Orientation orientation) const
 {
-    return lookup(m_store, orientation,
-                  m_style_name.toLocal8Bit(),
-                  QByteArray("key-top-row-height")).toReal();
+    return m_active_metrics[orientationIndex(orientation)]->key_top_row_height;
 }
 
 
@@ -467,9 +624,7 @@ qreal StyleAttributes::keyTopRowHeight(Logic::LayoutHelper::Orientation orientat
 //! @returns Value of "${style}\${orientation}\key-height".
 qreal StyleAttributes::keyBottomRowHeight(Logic::LayoutHelper::Orientation orientation) const
 {
-    return lookup(m_store, orientation,
-                  m_style_name.toLocal8Bit(),
-                  QByteArray("key-bottom-row-height")).toReal();
+    return m_active_metrics[orientationIndex(orientation)]->key_bottom_row_height;
 }
 
 
@@ -478,9 +633,7 @@ qreal StyleAttributes::keyBottomRowHeight(Logic::LayoutHelper::Orientation orien
 //! @returns Value of "${style}\${orientation}\magnifier-key-width".
 qreal StyleAttributes::magnifierKeyWidth(Logic::LayoutHelper::Orientation orientation) const
 {
-    return lookup(m_store, orientation,
-                  m_style_name.toLocal8Bit(),
-                  QByteArray("magnifier-key-width")).toReal();
+    return m_active_metrics[orientationIndex(orientation)]->magnifier_key_width;
 }
 
 
@@ -491,9 +644,7 @@ qreal StyleAttributes::magnifierKeyWidth(Logic::LayoutHelper::Orientation orient
 qreal StyleAttributes::keyWidth(Logic::LayoutHelper::Orientation orientation,
                                 KeyDescription::Width width) const
 {
-    return lookup(m_store, orientation,
-                  m_style_name.toLocal8Bit(),
-                  QByteArray("key-width").append(fromKeyWidth(width))).toReal();
+    return m_active_metrics[orientationIndex(orientation)]->key_widths[width];
 }
 
 
@@ -502,9 +653,7 @@ qreal StyleAttributes::keyWidth(Logic::LayoutHelper::Orientation orientation,
 //! @returns Value of "${style}\${orientation}\key-area-width".
 qreal StyleAttributes::keyAreaWidth(Logic::LayoutHelper::Orientation orientation) const
 {
-    return lookup(m_store, orientation,
-                  m_style_name.toLocal8Bit(),
-                  QByteArray("key-area-width")).toReal();
+    return m_active_metrics[orientationIndex(orientation)]->key_area_width;
 }
 
 
@@ -517,9 +666,7 @@ qreal StyleAttributes::keyAreaWidth(Logic::LayoutHelper::Orientation orientation
 //! @returns Value of "${style}\${orientation}\key-margins".
 qreal StyleAttributes::keyMargin(Logic::LayoutHelper::Orientation orientation) const
 {
-    return lookup(m_store, orientation,
-                  m_style_name.toLocal8Bit(),
-                  QByteArray("key-margins")).toReal();
+    return m_active_metrics[orientationIndex(orientation)]->key_margin;
 }
 
 //! \brief Looks up the key area paddings.
@@ -532,9 +679,7 @@ qreal StyleAttributes::keyMargin(Logic::LayoutHelper::Orientation orientation) c
 //! @returns Value of "${style}\${orientation}\key-area-paddings".
 qreal StyleAttributes::keyAreaPadding(Logic::LayoutHelper::Orientation orientation) const
 {
-    return lookup(m_store, orientation,
-                  m_style_name.toLocal8Bit(),
-                  QByteArray("key-area-paddings")).toReal();
+    return m_active_metrics[orientationIndex(orientation)]->key_area_padding;
 }
 
 
@@ -546,9 +691,7 @@ qreal StyleAttributes::keyAreaPadding(Logic::LayoutHelper::Orientation orientati
 //! @returns Value of "${style}\${orientation}\vertical-offset".
 qreal StyleAttributes::verticalOffset(Logic::LayoutHelper::Orientation orientation) const
 {
-    return lookup(m_store, orientation,
-                  m_style_name.toLocal8Bit(),
-                  QByteArray("vertical-offset")).toReal();
+    return m_active_metrics[orientationIndex(orientation)]->vertical_offset;
 }
 
 
@@ -557,9 +700,7 @@ qreal StyleAttributes::verticalOffset(Logic::LayoutHelper::Orientation orientati
 //! @returns Value of "${style}\${orientation}\magnifier-key-label-vertical-offset".
 qreal StyleAttributes::magnifierKeyLabelVerticalOffset(Logic::LayoutHelper::Orientation orientation) const
 {
-    return lookup(m_store, orientation,
-                  m_style_name.toLocal8Bit(),
-                  QByteArray("magnifier-key-label-vertical-offset")).toReal();
+    return m_active_metrics[orientationIndex(orientation)]->magnifier_key_label_vertical_offset;
 }
 
 
@@ -571,9 +712,7 @@ qreal StyleAttributes::magnifierKeyLabelVerticalOffset(Logic::LayoutHelper::Orie
 //! @returns Value of "${style}\${orientation}\safety-margin".
 qreal StyleAttributes::safetyMargin(Logic::LayoutHelper::Orientation orientation) const
 {
-    return lookup(m_store, orientation,
-                  m_style_name.toLocal8Bit(),
-                  QByteArray("safety-margin")).toReal();
+    return m_active_metrics[orientationIndex(orientation)]->safety_margin;
 }
 
 
@@ -581,7 +720,7 @@ qreal StyleAttributes::safetyMargin(Logic::LayoutHelper::Orientation orientation
 //! @returns Value of "sound/key-press".
 QByteArray StyleAttributes::keyPressSound() const
 {
-    return m_store->value("sound/key-press").toByteArray();
+    return m_key_press_sound;
 }
 
 
@@ -589,7 +728,7 @@ QByteArray StyleAttributes::keyPressSound() const
 //! @returns Value of "sound/key-release".
 QByteArray StyleAttributes::keyReleaseSound() const
 {
-    return m_store->value("sound/key-release").toByteArray();
+    return m_key_release_sound;
 }
 
 
@@ -597,7 +736,7 @@ QByteArray StyleAttributes::keyReleaseSound() const
 //! @returns Value of "sound/layout-change".
 QByteArray StyleAttributes::layoutChangeSound() const
 {
-    return m_store->value("sound/layout-change").toByteArray();
+    return m_layout_change_sound;
 }
 
 
@@ -605,7 +744,7 @@ QByteArray StyleAttributes::layoutChangeSound() const
 //! @returns Value of "sound/keyboard-hide".
 QByteArray StyleAttributes::keyboardHideSound() const
 {
-    return m_store->value("sound/keyboard-hide").toByteArray();
+    return m_keyboard_hide_sound;
 }
 
 } // namespace MaliitKeyboard
@@ -34,28 +34,60 @@
 #define MALIIT_KEYBOARD_STYLEATTRIBUTES_H
 
 #include "models/keydescription.h"
+#include "models/imageatlas.h"
 #include "logic/layouthelper.h"
 
 #include <QtCore>
 
 namespace MaliitKeyboard {
 
+//! Background image and 9-tiling borders of a key in a given state.
+struct KeyBackground
+{
+    QByteArray image;
+    QMargins borders;
+};
+
 class StyleAttributes
 {
 private:
-    const QScopedPointer<const QSettings> m_store;
+    struct Metrics;
+    typedef QSharedPointer<const Metrics> SharedMetrics;
+
     QString m_style_name;
+    QHash<QByteArray, SharedMetrics> m_metrics;
+    const Metrics *m_active_metrics[2];
+
+    QByteArray m_word_ribbon_background;
+    QByteArray m_key_area_background;
+    QByteArray m_magnifier_key_background;
+    QVector<KeyBackground> m_key_backgrounds;
+    QMargins m_word_ribbon_background_borders;
+    QMargins m_key_area_background_borders;
+    QMargins m_magnifier_key_background_borders;
+    QMargins m_key_background_borders;
+    QVector<QByteArray> m_icons;
+    QHash<QByteArray, QByteArray> m_custom_icons;
+    QStringList m_font_files;
+    QByteArray m_key_press_sound;
+    QByteArray m_key_release_sound;
+    QByteArray m_layout_change_sound;
+    QByteArray m_keyboard_hide_sound;
+    ImageAtlas m_image_atlas;
 
 public:
     explicit StyleAttributes(const QSettings *store);
     virtual ~StyleAttributes();
 
     virtual void setStyleName(const QString &name);
+    QString styleName() const;
     QByteArray wordRibbonBackground() const;
     QByteArray keyAreaBackground() const;
     QByteArray magnifierKeyBackground() const;
     QByteArray keyBackground(Key::Style style,
                              KeyDescription::State state) const;
+    const KeyBackground & keyStateBackground(Key::Style style,
+                                             KeyDescription::State state) const;
 
     QMargins wordRibbonBackgroundBorders() const;
     QMargins keyAreaBackgroundBorders() const;
@@ -69,6 +101,9 @@ public:
 
     QStringList fontFiles() const;
 
+    void setImageAtlas(const ImageAtlas &atlas);
+    const ImageAtlas & imageAtlas() const;
+
     QByteArray fontName(Logic::LayoutHelper::Orientation orientation) const;
     QByteArray fontColor(Logic::LayoutHelper::Orientation orientation) const;
     qreal fontSize(Logic::LayoutHelper::Orientation orientation) const;
@@ -50,22 +50,86 @@ class TagRow;
 class TagSection;
 class TagSpacer;
 
-// There may be some warnings caused by having forward declared shared
-// pointers to forward declared classes. We ignore them as this likely
-// is a bug in either Qt (QTBUG-18092) or g++ (seemingly 4.6 as I
-// don't have this issue in 4.7) or both.
-typedef QSharedPointer<TagBinding> TagBindingPtr;
-typedef QSharedPointer<TagBindingContainer> TagBindingContainerPtr;
-typedef QSharedPointer<TagExtended> TagExtendedPtr;
+//! Non-owning reference to a tag. All tags of a layout file live in one
+//! TagArena, which is kept alive by the TagKeyboardPtr of their tree, so
+//! references must not outlive that keyboard.
+template <typename T>
+class TagRef
+{
+private:
+    T *m_tag;
+    typedef T *TagRef::*RestrictedBool;
+
+public:
+    TagRef()
+        : m_tag(0)
+    {}
+
+    explicit TagRef(T *tag)
+        : m_tag(tag)
+    {}
+
+    // Allows the same implicit upcasts QSharedPointer did, e.g. from
+    // TagKeyPtr to TagRowElementPtr.
+    template <typename U>
+    TagRef(const TagRef<U> &other)
+        : m_tag(other.data())
+    {}
+
+    T *data() const
+    {
+        return m_tag;
+    }
+
+    T *operator->() const
+    {
+        return m_tag;
+    }
+
+    T &operator*() const
+    {
+        return *m_tag;
+    }
+
+    bool isNull() const
+    {
+        return (m_tag == 0);
+    }
+
+    void clear()
+    {
+        m_tag = 0;
+    }
+
+    template <typename U>
+    TagRef<U> staticCast() const
+    {
+        return TagRef<U>(static_cast<U *>(m_tag));
+    }
+
+    operator RestrictedBool() const
+    {
+        return (m_tag ? &TagRef::m_tag : 0);
+    }
+
+    bool operator!() const
+    {
+        return (m_tag == 0);
+    }
+};
+
+typedef TagRef<TagBinding> TagBindingPtr;
+typedef TagRef<TagBindingContainer> TagBindingContainerPtr;
+typedef TagRef<TagExtended> TagExtendedPtr;
 typedef QSharedPointer<TagKeyboard> TagKeyboardPtr;
-typedef QSharedPointer<TagKey> TagKeyPtr;
-typedef QSharedPointer<TagLayout> TagLayoutPtr;
-typedef QSharedPointer<TagModifiers> TagModifiersPtr;
-typedef QSharedPointer<TagRowContainer> TagRowContainerPtr;
-typedef QSharedPointer<TagRowElement> TagRowElementPtr;
-typedef QSharedPointer<TagRow> TagRowPtr;
-typedef QSharedPointer<TagSection> TagSectionPtr;
-typedef QSharedPointer<TagSpacer> TagSpacerPtr;
+typedef TagRef<TagKey> TagKeyPtr;
+typedef TagRef<TagLayout> TagLayoutPtr;
+typedef TagRef<TagModifiers> TagModifiersPtr;
+typedef TagRef<TagRowContainer> TagRowContainerPtr;
+typedef TagRef<TagRowElement> TagRowElementPtr;
+typedef TagRef<TagRow> TagRowPtr;
+typedef TagRef<TagSection> TagSectionPtr;
+typedef TagRef<TagSpacer> TagSpacerPtr;
 
 typedef QList<TagModifiersPtr> TagModifiersPtrs;
 typedef QList<TagSectionPtr> TagSectionPtrs;
@@ -75,4 +139,8 @@ typedef QList<TagRowPtr> TagRowPtrs;
 
 } // namespace MaliitKeyboard
 
+// Lets QList store tag references in place, like it does for plain pointers.
+template <typename T>
+Q_DECLARE_TYPEINFO_BODY(MaliitKeyboard::TagRef<T>, Q_MOVABLE_TYPE);
+
 #endif // MALIIT_KEYBOARD_ALL_TAG_TYPES_H
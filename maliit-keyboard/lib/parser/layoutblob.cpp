@@ -0,0 +1,613 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012 Openismus GmbH. All rights reserved.
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "layoutblob.h"
+#include "layoutparser.h"
+#include "models/key.h"
+
+namespace MaliitKeyboard {
+
+//! \class LayoutBlobWriter
+//! Writes the tag tree of a parsed layout file in a compact binary format
+//! that LayoutBlobReader can read from a memory mapped file, without going
+//! through QXmlStreamReader.
+//!
+//! All integers are little endian 32 bit words. A blob consists of
+//!   - a header: magic, format version, source size (two words), number of
+//!     strings, length of string data in UTF-16 code units, number of tree
+//!     words,
+//!   - the string table: offset and length of each string,
+//!   - the tree words: keyboard, layouts, sections, rows, keys, bindings,
+//!     modifiers and extended rows in document order, each followed by the
+//!     number of its children; strings are referred to by index,
+//!   - the string data, UTF-16 little endian, each string stored once.
+
+//! \class LayoutBlobReader
+//! Recreates the tag tree of a layout from a blob written by
+//! LayoutBlobWriter. The file is memory mapped and decoded in place; each
+//! distinct string is decoded once and shared by all tags using it. Tags
+//! are allocated in a TagArena, like LayoutParser does.
+
+const char *const CompiledLayoutSuffix = ".lbin";
+
+namespace {
+
+const quint32 BlobMagic(0x424c4b4d); // "MKLB"
+const quint32 BlobVersion(1);
+const quint32 HeaderWords(7);
+
+enum HeaderField {
+    MagicField,
+    VersionField,
+    SourceSizeLowField,
+    SourceSizeHighField,
+    StringCountField,
+    StringDataLengthField,
+    WordCountField
+};
+
+void appendWord(QByteArray *data,
+                quint32 word)
+{
+    uchar bytes[sizeof(quint32)];
+
+    qToLittleEndian(word, bytes);
+    data->append(reinterpret_cast<const char *>(bytes), sizeof(quint32));
+}
+
+quint32 wordAt(const uchar *data,
+               quint32 index)
+{
+    return qFromLittleEndian<quint32>(data + index * sizeof(quint32));
+}
+
+} // unnamed namespace
+
+LayoutBlobWriter::LayoutBlobWriter(QIODevice *device)
+    : m_device(device)
+    , m_error()
+    , m_words()
+    , m_strings()
+    , m_string_indices()
+{}
+
+//! \brief Writes the layout held by a successfully run parser.
+//! \param parser A parser on which parse() succeeded.
+//! \param source_size Size of the XML file, used to detect stale blobs.
+bool LayoutBlobWriter::write(const LayoutParser &parser,
+                             qint64 source_size)
+{
+    const TagKeyboardPtr keyboard(parser.keyboard());
+
+    if (not keyboard) {
+        m_error = "No keyboard to write.";
+        return false;
+    }
+
+    m_words.clear();
+    m_strings.clear();
+    m_string_indices.clear();
+
+    writeString(keyboard->version());
+    writeString(keyboard->title());
+    writeString(keyboard->language());
+    writeString(keyboard->catalog());
+    writeWord(keyboard->autocapitalization());
+    writeStringList(parser.imports());
+    writeStringList(parser.symviews());
+    writeStringList(parser.numbers());
+    writeStringList(parser.phonenumbers());
+
+    const TagLayoutPtrs layouts(keyboard->layouts());
+    writeWord(layouts.size());
+
+    Q_FOREACH (const TagLayoutPtr &layout, layouts) {
+        writeWord(layout->type());
+        writeWord(layout->orientation());
+        writeWord(layout->uniform_font_size());
+
+        const TagSectionPtrs sections(layout->sections());
+        writeWord(sections.size());
+
+        Q_FOREACH (const TagSectionPtr &section, sections) {
+            writeString(section->id());
+            writeWord(section->movable());
+            writeWord(section->type());
+            writeString(section->style());
+            writeRows(section->rows());
+        }
+    }
+
+    QByteArray string_data;
+    QByteArray string_table;
+    quint32 string_data_length(0);
+
+    Q_FOREACH (const QString &string, m_strings) {
+        appendWord(&string_table, string_data_length);
+        appendWord(&string_table, string.size());
+
+        for (int index = 0; index < string.size(); ++index) {
+            uchar bytes[sizeof(quint16)];
+
+            qToLittleEndian(string.at(index).unicode(), bytes);
+            string_data.append(reinterpret_cast<const char *>(bytes), sizeof(quint16));
+        }
+        string_data_length += string.size();
+    }
+
+    QByteArray blob;
+    blob.reserve(HeaderWords * sizeof(quint32) + string_table.size()
+                 + m_words.size() * sizeof(quint32) + string_data.size());
+
+    appendWord(&blob, BlobMagic);
+    appendWord(&blob, BlobVersion);
+    appendWord(&blob, static_cast<quint32>(source_size & 0xffffffff));
+    appendWord(&blob, static_cast<quint32>(source_size >> 32));
+    appendWord(&blob, m_strings.size());
+    appendWord(&blob, string_data_length);
+    appendWord(&blob, m_words.size());
+    blob.append(string_table);
+
+    Q_FOREACH (quint32 word, m_words) {
+        appendWord(&blob, word);
+    }
+
+    blob.append(string_data);
+
+    if (m_device->write(blob) != blob.size()) {
+        m_error = m_device->errorString();
+        return false;
+    }
+
+    return true;
+}
+
+const QString LayoutBlobWriter::errorString() const
+{
+    return m_error;
+}
+
+void LayoutBlobWriter::writeWord(quint32 word)
+{
+    m_words.append(word);
+}
+
+void LayoutBlobWriter::writeString(const QString &string)
+{
+    QHash<QString, quint32>::const_iterator it(m_string_indices.find(string));
+
+    if (it == m_string_indices.constEnd()) {
+        it = m_string_indices.insert(string, m_strings.size());
+        m_strings.append(string);
+    }
+
+    writeWord(it.value());
+}
+
+void LayoutBlobWriter::writeStringList(const QStringList &list)
+{
+    writeWord(list.size());
+
+    Q_FOREACH (const QString &string, list) {
+        writeString(string);
+    }
+}
+
+void LayoutBlobWriter::writeRows(const TagRowPtrs &rows)
+{
+    writeWord(rows.size());
+
+    Q_FOREACH (const TagRowPtr &row, rows) {
+        const TagRowElementPtrs elements(row->elements());
+
+        writeWord(row->height());
+        writeWord(elements.size());
+
+        Q_FOREACH (const TagRowElementPtr &element, elements) {
+            writeWord(element->element_type());
+
+            if (element->element_type() == TagRowElement::Key) {
+                const TagKeyPtr key(element.staticCast<TagKey>());
+                const TagExtendedPtr extended(key->extended());
+
+                writeWord(key->style());
+                writeWord(key->width());
+                writeWord(key->rtl());
+                writeString(key->id());
+                writeBinding(key->binding());
+                writeWord(not extended.isNull());
+
+                if (extended) {
+                    writeRows(extended->rows());
+                }
+            }
+        }
+    }
+}
+
+void LayoutBlobWriter::writeBinding(const TagBindingPtr &binding)
+{
+    const TagModifiersPtrs all_modifiers(binding->modifiers());
+
+    writeWord(binding->action());
+    writeString(binding->label());
+    writeString(binding->secondary_label());
+    writeString(binding->accents());
+    writeString(binding->accented_labels());
+    writeString(binding->cycle_set());
+    writeString(binding->sequence());
+    writeString(binding->icon());
+    writeWord(binding->dead());
+    writeWord(binding->quick_pick());
+    writeWord(binding->rtl());
+    writeWord(binding->enlarge());
+    writeWord(all_modifiers.size());
+
+    Q_FOREACH (const TagModifiersPtr &modifiers, all_modifiers) {
+        writeWord(modifiers->keys());
+        writeBinding(modifiers->binding());
+    }
+}
+
+LayoutBlobReader::LayoutBlobReader(QFile *file)
+    : m_file(file)
+    , m_error()
+    , m_words(0)
+    , m_word_count(0)
+    , m_position(0)
+    , m_strings()
+    , m_arena(new TagArena)
+    , m_keyboard()
+    , m_imports()
+    , m_symviews()
+    , m_numbers()
+    , m_phonenumbers()
+{}
+
+//! \brief Reads the blob from the (opened) file.
+//! \param source_size Size of the XML file the blob is expected to be
+//!        compiled from. Blobs compiled from a different size are rejected.
+bool LayoutBlobReader::read(qint64 source_size)
+{
+    const qint64 size(m_file->size());
+    uchar *const data(m_file->map(0, size));
+    bool result(false);
+
+    if (data) {
+        result = readData(data, size, source_size);
+        m_file->unmap(data);
+    } else {
+        const QByteArray buffer(m_file->readAll());
+        result = readData(reinterpret_cast<const uchar *>(buffer.constData()), buffer.size(), source_size);
+    }
+
+    if (not result) {
+        m_keyboard.clear();
+    }
+
+    return result;
+}
+
+const QString LayoutBlobReader::errorString() const
+{
+    return m_error;
+}
+
+const TagKeyboardPtr LayoutBlobReader::keyboard() const
+{
+    return m_keyboard;
+}
+
+const QStringList LayoutBlobReader::imports() const
+{
+    return m_imports;
+}
+
+const QStringList LayoutBlobReader::symviews() const
+{
+    return m_symviews;
+}
+
+const QStringList LayoutBlobReader::numbers() const
+{
+    return m_numbers;
+}
+
+const QStringList LayoutBlobReader::phonenumbers() const
+{
+    return m_phonenumbers;
+}
+
+bool LayoutBlobReader::readData(const uchar *data,
+                                qint64 size,
+                                qint64 source_size)
+{
+    if (size < static_cast<qint64>(HeaderWords * sizeof(quint32))) {
+        error("Blob too small.");
+        return false;
+    }
+
+    if (wordAt(data, MagicField) != BlobMagic) {
+        error("Not a compiled layout.");
+        return false;
+    }
+
+    if (wordAt(data, VersionField) != BlobVersion) {
+        error(QString::fromLatin1("Unsupported version %1.").arg(wordAt(data, VersionField)));
+        return false;
+    }
+
+    const qint64 compiled_size(static_cast<qint64>(wordAt(data, SourceSizeLowField))
+                               | (static_cast<qint64>(wordAt(data, SourceSizeHighField)) << 32));
+
+    if (compiled_size != source_size) {
+        error("Blob is out of date.");
+        return false;
+    }
+
+    const quint32 string_count(wordAt(data, StringCountField));
+    const quint32 string_data_length(wordAt(data, StringDataLengthField));
+    const quint32 word_count(wordAt(data, WordCountField));
+    const qint64 table_offset(HeaderWords * sizeof(quint32));
+    const qint64 words_offset(table_offset + static_cast<qint64>(string_count) * 2 * sizeof(quint32));
+    const qint64 string_data_offset(words_offset + static_cast<qint64>(word_count) * sizeof(quint32));
+
+    if (string_data_offset + static_cast<qint64>(string_data_length) * sizeof(quint16) != size) {
+        error("Blob size does not match its header.");
+        return false;
+    }
+
+    const uchar *const string_data(data + string_data_offset);
+
+    m_strings.resize(string_count);
+
+    for (quint32 index = 0; index < string_count; ++index) {
+        const quint32 offset(wordAt(data + table_offset, index * 2));
+        const quint32 length(wordAt(data + table_offset, index * 2 + 1));
+
+        if (offset > string_data_length || length > string_data_length - offset) {
+            error(QString::fromLatin1("String %1 out of bounds.").arg(index));
+            return false;
+        }
+
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+        m_strings[index] = QString(reinterpret_cast<const QChar *>(string_data + offset * sizeof(quint16)), length);
+#else
+        QString &string(m_strings[index]);
+
+        string.resize(length);
+        for (quint32 char_index = 0; char_index < length; ++char_index) {
+            string[char_index] = QChar(qFromLittleEndian<quint16>(string_data + (offset + char_index) * sizeof(quint16)));
+        }
+#endif
+    }
+
+    m_words = data + words_offset;
+    m_word_count = word_count;
+    m_position = 0;
+
+    const QString version(readString());
+    const QString title(readString());
+    const QString language(readString());
+    const QString catalog(readString());
+    const bool autocapitalization(readBool());
+
+    m_imports = readStringList();
+    m_symviews = readStringList();
+    m_numbers = readStringList();
+    m_phonenumbers = readStringList();
+    m_keyboard = adoptKeyboard(m_arena, new (m_arena->allocate(sizeof(TagKeyboard)))
+                               TagKeyboard(version, title, language,
+                                           catalog, autocapitalization));
+
+    const quint32 layout_count(readCount());
+
+    for (quint32 layout_index = 0; layout_index < layout_count && m_error.isEmpty(); ++layout_index) {
+        const TagLayout::LayoutType type(static_cast<TagLayout::LayoutType>(readEnum(TagLayout::Common + 1)));
+        const TagLayout::LayoutOrientation orientation(static_cast<TagLayout::LayoutOrientation>(readEnum(TagLayout::Portrait + 1)));
+        const bool uniform_font_size(readBool());
+        const TagLayoutPtr new_layout(m_arena->adopt(new (m_arena->allocate(sizeof(TagLayout)))
+                                                     TagLayout(type, orientation, uniform_font_size)));
+        const quint32 section_count(readCount());
+
+        // LayoutParser requires a section per layout, and so do its users:
+        if (section_count == 0) {
+            error("Layout without sections.");
+        }
+
+        m_keyboard->appendLayout(new_layout);
+
+        for (quint32 section_index = 0; section_index < section_count && m_error.isEmpty(); ++section_index) {
+            const QString id(readString());
+            const bool movable(readBool());
+            const TagSection::SectionType section_type(static_cast<TagSection::SectionType>(readEnum(TagSection::Nonsloppy + 1)));
+            const QString style(readString());
+            const TagSectionPtr new_section(m_arena->adopt(new (m_arena->allocate(sizeof(TagSection)))
+                                                           TagSection(id, movable, section_type, style)));
+
+            new_layout->appendSection(new_section);
+            readRows(new_section);
+        }
+    }
+
+    m_words = 0;
+
+    if (m_error.isEmpty() && m_position != m_word_count) {
+        error("Trailing data after layout.");
+    }
+
+    return m_error.isEmpty();
+}
+
+void LayoutBlobReader::error(const QString &message)
+{
+    if (m_error.isEmpty()) {
+        m_error = QString::number(m_position) + " - " + message;
+    }
+}
+
+quint32 LayoutBlobReader::readWord()
+{
+    if (m_position >= m_word_count) {
+        error("Unexpected end of blob.");
+        return 0;
+    }
+
+    return wordAt(m_words, m_position++);
+}
+
+// Every counted item takes at least one word, so counts exceeding the
+// remaining words are corrupt and would only make us allocate in vain.
+quint32 LayoutBlobReader::readCount()
+{
+    const quint32 count(readWord());
+
+    if (count > m_word_count - m_position) {
+        error(QString::fromLatin1("Count %1 out of bounds.").arg(count));
+        return 0;
+    }
+
+    return count;
+}
+
+quint32 LayoutBlobReader::readEnum(quint32 count)
+{
+    const quint32 value(readWord());
+
+    if (value >= count) {
+        error(QString::fromLatin1("Enum value %1 out of range.").arg(value));
+        return 0;
+    }
+
+    return value;
+}
+
+bool LayoutBlobReader::readBool()
+{
+    return (readEnum(2) != 0);
+}
+
+QString LayoutBlobReader::readString()
+{
+    const quint32 index(readWord());
+
+    if (index >= static_cast<quint32>(m_strings.size())) {
+        error(QString::fromLatin1("String index %1 out of range.").arg(index));
+        return QString();
+    }
+
+    return m_strings.at(index);
+}
+
+QStringList LayoutBlobReader::readStringList()
+{
+    QStringList list;
+    const quint32 count(readCount());
+
+    for (quint32 index = 0; index < count && m_error.isEmpty(); ++index) {
+        list.append(readString());
+    }
+
+    return list;
+}
+
+void LayoutBlobReader::readRows(const TagRowContainerPtr &container)
+{
+    const quint32 row_count(readCount());
+
+    for (quint32 row_index = 0; row_index < row_count && m_error.isEmpty(); ++row_index) {
+        const TagRow::Height height(static_cast<TagRow::Height>(readEnum(TagRow::XXLarge + 1)));
+        const TagRowPtr new_row(m_arena->adopt(new (m_arena->allocate(sizeof(TagRow))) TagRow(height)));
+        const quint32 element_count(readCount());
+
+        container->appendRow(new_row);
+
+        for (quint32 element_index = 0; element_index < element_count && m_error.isEmpty(); ++element_index) {
+            if (readEnum(TagRowElement::Spacer + 1) == TagRowElement::Spacer) {
+                new_row->appendElement(TagSpacerPtr(m_arena->adopt(new (m_arena->allocate(sizeof(TagSpacer)))
+                                                                   TagSpacer)));
+                continue;
+            }
+
+            const TagKey::Style style(static_cast<TagKey::Style>(readEnum(TagKey::Activated + 1)));
+            const TagKey::Width width(static_cast<TagKey::Width>(readEnum(TagKey::Stretched + 1)));
+            const bool rtl(readBool());
+            const QString id(readString());
+            const TagKeyPtr new_key(m_arena->adopt(new (m_arena->allocate(sizeof(TagKey)))
+                                                   TagKey(style, width, rtl, id)));
+
+            new_row->appendElement(new_key);
+            new_key->setBinding(readBinding());
+
+            if (readBool()) {
+                const TagExtendedPtr new_extended(m_arena->adopt(new (m_arena->allocate(sizeof(TagExtended)))
+                                                                 TagExtended));
+
+                new_key->setExtended(new_extended);
+                readRows(new_extended);
+            }
+        }
+    }
+}
+
+TagBindingPtr LayoutBlobReader::readBinding()
+{
+    const TagBinding::Action action(static_cast<TagBinding::Action>(readEnum(Key::NumActions)));
+    const QString label(readString());
+    const QString secondary_label(readString());
+    const QString accents(readString());
+    const QString accented_labels(readString());
+    const QString cycle_set(readString());
+    const QString sequence(readString());
+    const QString icon(readString());
+    const bool dead(readBool());
+    const bool quick_pick(readBool());
+    const bool rtl(readBool());
+    const bool enlarge(readBool());
+    const TagBindingPtr new_binding(m_arena->adopt(new (m_arena->allocate(sizeof(TagBinding)))
+                                                   TagBinding(action, label, secondary_label, accents,
+                                                              accented_labels, cycle_set, sequence, icon,
+                                                              dead, quick_pick, rtl, enlarge)));
+    const quint32 modifiers_count(readCount());
+
+    for (quint32 index = 0; index < modifiers_count && m_error.isEmpty(); ++index) {
+        const TagModifiers::Keys keys(static_cast<TagModifiers::Keys>(readEnum(TagModifiers::AltShift + 1)));
+        const TagModifiersPtr new_modifiers(m_arena->adopt(new (m_arena->allocate(sizeof(TagModifiers)))
+                                                           TagModifiers(keys)));
+
+        new_binding->appendModifiers(new_modifiers);
+        new_modifiers->setBinding(readBinding());
+    }
+
+    return new_binding;
+}
+
+} // namespace MaliitKeyboard
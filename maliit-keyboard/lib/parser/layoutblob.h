@@ -0,0 +1,121 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012 Openismus GmbH. All rights reserved.
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef MALIIT_KEYBOARD_LAYOUTBLOB_H
+#define MALIIT_KEYBOARD_LAYOUTBLOB_H
+
+#include <QtCore>
+
+#include "alltagtypes.h"
+#include "tagarena.h"
+
+namespace MaliitKeyboard {
+
+class LayoutParser;
+
+//! Compiled layouts are stored next to their XML source, with this suffix
+//! replacing ".xml".
+extern const char *const CompiledLayoutSuffix;
+
+class LayoutBlobWriter
+{
+    Q_DISABLE_COPY(LayoutBlobWriter)
+
+private:
+    QIODevice *const m_device;
+    QString m_error;
+    QVector<quint32> m_words;
+    QStringList m_strings;
+    QHash<QString, quint32> m_string_indices;
+
+public:
+    explicit LayoutBlobWriter(QIODevice *device);
+
+    bool write(const LayoutParser &parser,
+               qint64 source_size);
+    const QString errorString() const;
+
+private:
+    void writeWord(quint32 word);
+    void writeString(const QString &string);
+    void writeStringList(const QStringList &list);
+    void writeRows(const TagRowPtrs &rows);
+    void writeBinding(const TagBindingPtr &binding);
+};
+
+class LayoutBlobReader
+{
+    Q_DISABLE_COPY(LayoutBlobReader)
+
+private:
+    QFile *const m_file;
+    QString m_error;
+    const uchar *m_words;
+    quint32 m_word_count;
+    quint32 m_position;
+    QVector<QString> m_strings;
+    const TagArenaPtr m_arena;
+    TagKeyboardPtr m_keyboard;
+    QStringList m_imports;
+    QStringList m_symviews;
+    QStringList m_numbers;
+    QStringList m_phonenumbers;
+
+public:
+    explicit LayoutBlobReader(QFile *file);
+
+    bool read(qint64 source_size);
+    const QString errorString() const;
+
+    const TagKeyboardPtr keyboard() const;
+    const QStringList imports() const;
+    const QStringList symviews() const;
+    const QStringList numbers() const;
+    const QStringList phonenumbers() const;
+
+private:
+    bool readData(const uchar *data,
+                  qint64 size,
+                  qint64 source_size);
+    void error(const QString &message);
+    quint32 readWord();
+    quint32 readCount();
+    quint32 readEnum(quint32 count);
+    bool readBool();
+    QString readString();
+    QStringList readStringList();
+    void readRows(const TagRowContainerPtr &container);
+    TagBindingPtr readBinding();
+};
+
+} // namespace MaliitKeyboard
+
+#endif // MALIIT_KEYBOARD_LAYOUTBLOB_H
@@ -40,6 +40,7 @@ namespace MaliitKeyboard {
 
 LayoutParser::LayoutParser(QIODevice *device)
     : m_xml(device)
+    , m_arena(new TagArena)
     , m_keyboard()
     , m_imports()
     , m_symviews()
@@ -62,6 +63,36 @@ bool LayoutParser::parse()
     return not m_xml.hasError();
 }
 
+//! \brief Parses only the keyboard attributes and imports of a layout file.
+//!
+//! Layouts are skipped without building a tag tree for them, which makes
+//! this a lot cheaper than parse() for tools that only need to know title,
+//! language and imports of a layout file.
+bool LayoutParser::parseHeader()
+{
+    goToRootElement();
+
+    if (not m_xml.isStartElement() || m_xml.name() != QLatin1String("keyboard")) {
+        error(QString::fromLatin1("Expected '<keyboard>', but got '<%1>'.").arg(m_xml.name().toString()));
+    } else if (not m_xml.hasError()) {
+        parseKeyboardAttributes();
+
+        while (m_xml.readNextStartElement()) {
+            const QStringRef name(m_xml.name());
+
+            if (name == QLatin1String("import")) {
+                parseImport();
+            } else if (name == QLatin1String("layout")) {
+                m_xml.skipCurrentElement();
+            } else {
+                error(QString::fromLatin1("Expected '<layout>' or '<import>', but got '<%1>'.").arg(name.toString()));
+            }
+        }
+    }
+
+    return not m_xml.hasError();
+}
+
 bool LayoutParser::isLanguageFile()
 {
     goToRootElement();
@@ -103,15 +134,7 @@ void LayoutParser::error(const QString &message)
 
 void LayoutParser::parseKeyboard()
 {
-    const QXmlStreamAttributes attributes(m_xml.attributes());
-    const QString version(attributes.value(QLatin1String("version")).toString());
-    const QString actual_version(version.isEmpty() ? "1.0" : version);
-    const QString title(attributes.value(QLatin1String("title")).toString());
-    const QString language(attributes.value(QLatin1String("language")).toString());
-    const QString catalog(attributes.value(QLatin1String("catalog")).toString());
-    const bool autocapitalization(boolValue(attributes.value(QLatin1String("autocapitalization")), true));
-    m_keyboard = TagKeyboardPtr(new TagKeyboard(actual_version, title, language,
-                                                catalog, autocapitalization));
+    parseKeyboardAttributes();
 
     while (m_xml.readNextStartElement()) {
         const QStringRef name(m_xml.name());
@@ -126,6 +149,20 @@ void LayoutParser::parseKeyboard()
     }
 }
 
+void LayoutParser::parseKeyboardAttributes()
+{
+    const QXmlStreamAttributes attributes(m_xml.attributes());
+    const QString version(m_arena->intern(attributes.value(QLatin1String("version"))));
+    const QString actual_version(version.isEmpty() ? "1.0" : version);
+    const QString title(m_arena->intern(attributes.value(QLatin1String("title"))));
+    const QString language(m_arena->intern(attributes.value(QLatin1String("language"))));
+    const QString catalog(m_arena->intern(attributes.value(QLatin1String("catalog"))));
+    const bool autocapitalization(boolValue(attributes.value(QLatin1String("autocapitalization")), true));
+    m_keyboard = adoptKeyboard(m_arena, new (m_arena->allocate(sizeof(TagKeyboard)))
+                               TagKeyboard(actual_version, title, language,
+                                           catalog, autocapitalization));
+}
+
 bool LayoutParser::boolValue(const QStringRef &value, bool defaultValue) {
     if (value.isEmpty()) {
         return defaultValue;
@@ -245,7 +282,8 @@ void LayoutParser::parseLayout()
     const TagLayout::LayoutType type(enumValue("type", typeValues, TagLayout::General));
     const TagLayout::LayoutOrientation orientation(enumValue("orientation", orientationValues, TagLayout::Landscape));
     const bool uniform_font_size(boolValue(attributes.value(QLatin1String("uniform-font-size")), false));
-    TagLayoutPtr new_layout(TagLayoutPtr(new TagLayout(type, orientation, uniform_font_size)));
+    TagLayoutPtr new_layout(m_arena->adopt(new (m_arena->allocate(sizeof(TagLayout)))
+                                           TagLayout(type, orientation, uniform_font_size)));
     m_keyboard->appendLayout(new_layout);
 
     bool found_section(false);
@@ -295,10 +333,10 @@ void LayoutParser::parseSection(const TagLayoutPtr &layout)
     static const QStringList typeValues(QString::fromLatin1("sloppy,non-sloppy").split(','));
 
     const QXmlStreamAttributes attributes(m_xml.attributes());
-    const QString id(attributes.value(QLatin1String("id")).toString());
+    const QString id(m_arena->intern(attributes.value(QLatin1String("id"))));
     const bool movable(boolValue(attributes.value(QLatin1String("movable")), true));
     const TagSection::SectionType type(enumValue("type", typeValues, TagSection::Sloppy));
-    const QString style(attributes.value(QLatin1String("style")).toString());
+    const QString style(m_arena->intern(attributes.value(QLatin1String("style"))));
 
     if (id.isEmpty()) {
         error("Expected non-empty 'id' attribute in '<section>'.");
@@ -306,7 +344,8 @@ void LayoutParser::parseSection(const TagLayoutPtr &layout)
     }
 
 
-    TagSectionPtr new_section(new TagSection(id, movable, type, style));
+    TagSectionPtr new_section(m_arena->adopt(new (m_arena->allocate(sizeof(TagSection)))
+                                             TagSection(id, movable, type, style)));
     layout->appendSection(new_section);
 
     bool found_row(false);
@@ -333,7 +372,7 @@ void LayoutParser::parseRow(const TagRowContainerPtr &row_container)
     static const QStringList heightValues(QString::fromLatin1("small,medium,large,x-large,xx-large").split(','));
 
     const TagRow::Height height(enumValue("height", heightValues, TagRow::Medium));
-    TagRowPtr new_row(new TagRow(height));
+    TagRowPtr new_row(m_arena->adopt(new (m_arena->allocate(sizeof(TagRow))) TagRow(height)));
 
     row_container->appendRow (new_row);
 
@@ -359,8 +398,9 @@ void LayoutParser::parseKey(const TagRowPtr &row)
     const TagKey::Style style(enumValue("style", styleValues, TagKey::Normal));
     const TagKey::Width width(enumValue("width", widthValues, TagKey::Medium));
     const bool rtl(boolValue(attributes.value(QLatin1String("rtl")), false));
-    const QString id(attributes.value(QLatin1String("id")).toString());
-    TagKeyPtr new_key(new TagKey(style, width, rtl, id));
+    const QString id(m_arena->intern(attributes.value(QLatin1String("id"))));
+    TagKeyPtr new_key(m_arena->adopt(new (m_arena->allocate(sizeof(TagKey)))
+                                     TagKey(style, width, rtl, id)));
 
     row->appendElement(new_key);
 
@@ -401,20 +441,21 @@ void LayoutParser::parseBinding(const TagBindingContainerPtr &binding_container)
 
     const QXmlStreamAttributes attributes(m_xml.attributes());
     const TagBinding::Action action(enumValue("action", actionValues, TagBinding::Insert));
-    const QString label(attributes.value(QLatin1String("label")).toString());
-    const QString secondary_label(attributes.value(QLatin1String("secondary_label")).toString());
-    const QString accents(attributes.value(QLatin1String("accents")).toString());
-    const QString accented_labels(attributes.value(QLatin1String("accented_labels")).toString());
-    const QString cycleset(attributes.value(QLatin1String("cycleset")).toString());
-    const QString sequence(attributes.value(QLatin1String("sequence")).toString());
-    const QString icon(attributes.value(QLatin1String("icon")).toString());
+    const QString label(m_arena->intern(attributes.value(QLatin1String("label"))));
+    const QString secondary_label(m_arena->intern(attributes.value(QLatin1String("secondary_label"))));
+    const QString accents(m_arena->intern(attributes.value(QLatin1String("accents"))));
+    const QString accented_labels(m_arena->intern(attributes.value(QLatin1String("accented_labels"))));
+    const QString cycleset(m_arena->intern(attributes.value(QLatin1String("cycleset"))));
+    const QString sequence(m_arena->intern(attributes.value(QLatin1String("sequence"))));
+    const QString icon(m_arena->intern(attributes.value(QLatin1String("icon"))));
     const bool dead(boolValue(attributes.value(QLatin1String("dead")), false));
     const bool quick_pick(boolValue(attributes.value(QLatin1String("quick_pick")), false));
     const bool rtl(boolValue(attributes.value(QLatin1String("rtl")), false));
     const bool enlarge(boolValue(attributes.value(QLatin1String("enlarge")), false));
-    TagBindingPtr new_binding(new TagBinding(action, label, secondary_label, accents,
-                                             accented_labels, cycleset, sequence, icon,
-                                             dead, quick_pick, rtl, enlarge));
+    TagBindingPtr new_binding(m_arena->adopt(new (m_arena->allocate(sizeof(TagBinding)))
+                                             TagBinding(action, label, secondary_label, accents,
+                                                        accented_labels, cycleset, sequence, icon,
+                                                        dead, quick_pick, rtl, enlarge)));
 
     binding_container->setBinding(new_binding);
 
@@ -435,7 +476,8 @@ void LayoutParser::parseModifiers(const TagBindingPtr &binding)
 
     const QXmlStreamAttributes attributes(m_xml.attributes());
     const TagModifiers::Keys keys(enumValue("keys", keys_values, TagModifiers::Shift));
-    TagModifiersPtr new_modifiers(new TagModifiers(keys));
+    TagModifiersPtr new_modifiers(m_arena->adopt(new (m_arena->allocate(sizeof(TagModifiers)))
+                                                 TagModifiers(keys)));
 
     binding->appendModifiers(new_modifiers);
 
@@ -461,7 +503,8 @@ void LayoutParser::parseModifiers(const TagBindingPtr &binding)
 void LayoutParser::parseExtended(const TagKeyPtr &key)
 {
     bool found_row(false);
-    TagExtendedPtr new_extended(new TagExtended);
+    TagExtendedPtr new_extended(m_arena->adopt(new (m_arena->allocate(sizeof(TagExtended)))
+                                               TagExtended));
 
     key->setExtended(new_extended);
 
@@ -483,7 +526,7 @@ void LayoutParser::parseExtended(const TagKeyPtr &key)
 
 void LayoutParser::parseSpacer(const TagRowPtr &row)
 {
-    row->appendElement(TagSpacerPtr(new TagSpacer));
+    row->appendElement(TagSpacerPtr(m_arena->adopt(new (m_arena->allocate(sizeof(TagSpacer))) TagSpacer)));
     m_xml.skipCurrentElement();
 }
 
@@ -524,4 +567,10 @@ const QStringList LayoutParser::phonenumbers() const
     return m_phonenumbers;
 }
 
+//! \brief Returns the arena the tags of the parsed keyboard live in.
+const TagArenaPtr LayoutParser::arena() const
+{
+    return m_arena;
+}
+
 } // namespace MaliitKeyboard
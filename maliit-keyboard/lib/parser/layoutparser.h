@@ -38,6 +38,7 @@
 #include <QStringList>
 
 #include "alltagtypes.h"
+#include "tagarena.h"
 
 #include "tagbindingcontainer.h"
 #include "tagbinding.h"
@@ -60,6 +61,7 @@ public:
     explicit LayoutParser(QIODevice *device);
 
     bool parse();
+    bool parseHeader();
     bool isLanguageFile();
 
     const QString errorString() const;
@@ -69,9 +71,11 @@ public:
     const QStringList symviews() const;
     const QStringList numbers() const;
     const QStringList phonenumbers() const;
+    const TagArenaPtr arena() const;
 
 private:
     QXmlStreamReader m_xml;
+    const TagArenaPtr m_arena;
     TagKeyboardPtr m_keyboard;
     QStringList m_imports;
     QStringList m_symviews;
@@ -79,6 +83,7 @@ private:
     QStringList m_phonenumbers;
 
     void parseKeyboard();
+    void parseKeyboardAttributes();
     void parseImport();
     void parseNewStyleImport();
     void parseImportChild(QStringList *target_list);
@@ -3,6 +3,8 @@ PARSER_DIR = ./parser
 HEADERS += \
     parser/alltagtypes.h \
     parser/layoutparser.h \
+    parser/layoutblob.h \
+    parser/tagarena.h \
     parser/tagbindingcontainer.h \
     parser/tagbinding.h \
     parser/tagextended.h \
@@ -18,6 +20,8 @@ HEADERS += \
 
 SOURCES += \
     parser/layoutparser.cpp \
+    parser/layoutblob.cpp \
+    parser/tagarena.cpp \
     parser/tagbindingcontainer.cpp \
     parser/tagbinding.cpp \
     parser/tagextended.cpp \
@@ -0,0 +1,221 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012 Openismus GmbH. All rights reserved.
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "tagarena.h"
+#include "tagkeyboard.h"
+
+#include <cstdlib>
+
+namespace MaliitKeyboard {
+
+//! \class TagArena
+//! Bump allocator for the tag tree of one layout file. Tags are placement
+//! constructed in large blocks instead of being heap allocated one by one,
+//! and all blocks are freed at once when the last tag of the layout is
+//! destroyed. Attribute strings are interned, so that all tags using e.g.
+//! the same style name or accents share one string.
+//!
+//! The arena owns its tags (see adopt()) and destroys them together with
+//! its blocks. Tags refer to each other through non-owning TagRef's; only
+//! the keyboard at the root of the tree is handed out as a QSharedPointer
+//! (see adoptKeyboard()), whose single reference count block keeps the
+//! whole arena alive.
+//!
+//! Allocation and interning are not thread-safe; they are only meant to be
+//! used by the parser filling the arena.
+
+//! \param block_size Size of the blocks tags are allocated in.
+TagArena::TagArena(int block_size)
+    : m_block_size(qMax<int>(block_size, Alignment))
+    , m_blocks()
+    , m_offset(m_block_size)
+    , m_bytes_used(0)
+    , m_destructors(0)
+    , m_strings()
+{}
+
+
+TagArena::~TagArena()
+{
+    // Adopted tags are destroyed in reverse order of their creation.
+    for (Destructor *destructor = m_destructors; destructor; destructor = destructor->next) {
+        destructor->destroy(destructor->tag);
+    }
+
+    Q_FOREACH (char *block, m_blocks) {
+        std::free(block);
+    }
+}
+
+
+//! \brief Returns uninitialized memory, aligned for any tag type.
+void *TagArena::allocate(size_t size)
+{
+    const int aligned_size((size + Alignment - 1) & ~(Alignment - 1));
+
+    // Oversized requests get a block of their own, so that the current block
+    // can still be filled up.
+    if (aligned_size > m_block_size) {
+        char *const block(static_cast<char *>(std::malloc(aligned_size)));
+
+        Q_CHECK_PTR(block);
+        m_blocks.prepend(block);
+        m_bytes_used += aligned_size;
+        return block;
+    }
+
+    if (m_blocks.isEmpty() || m_offset + aligned_size > m_block_size) {
+        char *const block(static_cast<char *>(std::malloc(m_block_size)));
+
+        Q_CHECK_PTR(block);
+        m_blocks.append(block);
+        m_offset = 0;
+    }
+
+    void *const memory(m_blocks.last() + m_offset);
+
+    m_offset += aligned_size;
+    m_bytes_used += aligned_size;
+    return memory;
+}
+
+
+//! \brief Returns a string equal to string, sharing its data with all other
+//!        equal strings interned in this arena.
+QString TagArena::intern(const QString &string)
+{
+    if (string.isEmpty()) {
+        return QString();
+    }
+
+    const QStringRef ref(&string);
+    const uint hash(qHash(ref));
+    const QString found(lookup(hash, ref));
+
+    if (not found.isNull()) {
+        return found;
+    }
+
+    m_strings.insert(hash, string);
+    return string;
+}
+
+
+//! Attribute values from QXmlStreamReader are only copied into a new
+//! string if no equal string is interned yet.
+QString TagArena::intern(const QStringRef &string)
+{
+    if (string.isEmpty()) {
+        return QString();
+    }
+
+    const uint hash(qHash(string));
+    const QString found(lookup(hash, string));
+
+    if (not found.isNull()) {
+        return found;
+    }
+
+    const QString copy(string.toString());
+
+    m_strings.insert(hash, copy);
+    return copy;
+}
+
+
+QString TagArena::lookup(uint hash,
+                         const QStringRef &string) const
+{
+    for (QMultiHash<uint, QString>::const_iterator it(m_strings.constFind(hash));
+         it != m_strings.constEnd() && it.key() == hash;
+         ++it) {
+        if (it.value() == string) {
+            return it.value();
+        }
+    }
+
+    return QString();
+}
+
+
+//! \brief Returns the number of allocated blocks.
+int TagArena::blockCount() const
+{
+    return m_blocks.size();
+}
+
+
+//! \brief Returns the number of bytes handed out to tags.
+qint64 TagArena::bytesUsed() const
+{
+    return m_bytes_used;
+}
+
+
+//! \brief Returns the number of distinct interned strings.
+int TagArena::internedCount() const
+{
+    return m_strings.size();
+}
+
+
+namespace {
+
+// Holds the arena of a keyboard instead of deleting it; the arena
+// destroys the keyboard, like all of its other tags.
+class TagArenaHandle
+{
+private:
+    TagArenaPtr m_arena;
+
+public:
+    explicit TagArenaHandle(const TagArenaPtr &arena)
+        : m_arena(arena)
+    {}
+
+    void operator()(TagKeyboard *) const
+    {}
+};
+
+} // unnamed namespace
+
+
+//! \brief Returns the root of a tag tree allocated in arena.
+//!
+//! The returned pointer keeps the arena, and with it all tags of the tree,
+//! alive.
+TagKeyboardPtr adoptKeyboard(const TagArenaPtr &arena,
+                             TagKeyboard *keyboard)
+{
+    return TagKeyboardPtr(arena->adopt(keyboard), TagArenaHandle(arena));
+}
+
+} // namespace MaliitKeyboard
@@ -0,0 +1,111 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012 Openismus GmbH. All rights reserved.
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef MALIIT_KEYBOARD_TAGARENA_H
+#define MALIIT_KEYBOARD_TAGARENA_H
+
+#include <QtCore>
+
+#include <new>
+
+#include "alltagtypes.h"
+
+namespace MaliitKeyboard {
+
+class TagArena;
+typedef QSharedPointer<TagArena> TagArenaPtr;
+
+class TagArena
+{
+    Q_DISABLE_COPY(TagArena)
+
+private:
+    struct Destructor
+    {
+        void *tag;
+        void (*destroy)(void *tag);
+        Destructor *next;
+    };
+
+    const int m_block_size;
+    QList<char *> m_blocks;
+    int m_offset;
+    qint64 m_bytes_used;
+    Destructor *m_destructors;
+    QMultiHash<uint, QString> m_strings;
+
+    QString lookup(uint hash,
+                   const QStringRef &string) const;
+
+    template <typename T>
+    static void destroy(void *tag)
+    {
+        static_cast<T *>(tag)->~T();
+    }
+
+public:
+    enum {
+        DefaultBlockSize = 16 * 1024,
+        Alignment = 2 * sizeof(void *)
+    };
+
+    explicit TagArena(int block_size = DefaultBlockSize);
+    ~TagArena();
+
+    void *allocate(size_t size);
+    QString intern(const QString &string);
+    QString intern(const QStringRef &string);
+
+    //! Makes the arena destroy a tag placement-constructed in its memory,
+    //! e.g. TagRowPtr(arena->adopt(new (arena->allocate(sizeof(TagRow))) TagRow(height))).
+    template <typename T>
+    T *adopt(T *tag)
+    {
+        Destructor *const destructor(static_cast<Destructor *>(allocate(sizeof(Destructor))));
+
+        destructor->tag = tag;
+        destructor->destroy = &TagArena::destroy<T>;
+        destructor->next = m_destructors;
+        m_destructors = destructor;
+        return tag;
+    }
+
+    int blockCount() const;
+    qint64 bytesUsed() const;
+    int internedCount() const;
+};
+
+TagKeyboardPtr adoptKeyboard(const TagArenaPtr &arena,
+                             TagKeyboard *keyboard);
+
+} // namespace MaliitKeyboard
+
+#endif // MALIIT_KEYBOARD_TAGARENA_H
@@ -4,10 +4,16 @@ SUBDIRS = \
     lib \
     view \
     plugin \
-    data \
     qml \
-    benchmark \
+    benchmark
 
+# Build-time tools for data/, which cannot run on the build host when
+# cross-compiling:
+!cross_compile:!disable-precompiled-data {
+    SUBDIRS += layoutcompiler atlascompiler
+}
+
+SUBDIRS += data
 
 !notests {
     SUBDIRS += tests
@@ -34,6 +34,10 @@
 #include "editor.h"
 #include "updatenotifier.h"
 #include "maliitcontext.h"
+#include "keyboardrenderer.h"
+#include "keyboardinputarea.h"
+#include "startuptimeline.h"
+#include "styleimageprovider.h"
 
 #include "models/key.h"
 #include "models/keyarea.h"
@@ -46,6 +50,7 @@
 #include "logic/style.h"
 #include "logic/languagefeatures.h"
 #include "logic/eventhandler.h"
+#include "logic/layoutwarmup.h"
 
 #ifdef HAVE_QT_MOBILITY
 #include "view/soundfeedback.h"
@@ -113,6 +118,35 @@ QQuickView *getOverlaySurface (MAbstractInputMethodHost *host, QQuickView *paren
 const QString g_maliit_keyboard_qml(MALIIT_KEYBOARD_DATA_DIR "/maliit-keyboard.qml");
 const QString g_maliit_keyboard_extended_qml(MALIIT_KEYBOARD_DATA_DIR "/maliit-keyboard-extended.qml");
 const QString g_maliit_magnifier_qml(MALIIT_KEYBOARD_DATA_DIR "/maliit-magnifier.qml");
+const QString g_maliit_keyboard_single_qml(MALIIT_KEYBOARD_DATA_DIR "/maliit-keyboard-single.qml");
+const QString g_style_image_provider("maliit-style");
+
+//! Whether keys should be drawn by KeyboardRenderer instead of QML delegates,
+//! as requested through the MALIIT_KEYBOARD_NATIVE_RENDERING environment
+//! variable.
+bool nativeRenderingRequested()
+{
+    static const QByteArray value(qgetenv("MALIIT_KEYBOARD_NATIVE_RENDERING"));
+    return (not value.isEmpty() && value != "0");
+}
+
+//! Whether a single KeyboardInputArea should dispatch input for all keys,
+//! instead of a MouseArea per key, as requested through the
+//! MALIIT_KEYBOARD_NATIVE_INPUT environment variable.
+bool nativeInputRequested()
+{
+    static const QByteArray value(qgetenv("MALIIT_KEYBOARD_NATIVE_INPUT"));
+    return (not value.isEmpty() && value != "0");
+}
+
+//! Whether extended keys and magnifier should be overlay items in the main
+//! surface, sharing its window and QML engine, as requested through the
+//! MALIIT_KEYBOARD_SINGLE_WINDOW environment variable.
+bool singleWindowRequested()
+{
+    static const QByteArray value(qgetenv("MALIIT_KEYBOARD_SINGLE_WINDOW"));
+    return (not value.isEmpty() && value != "0");
+}
 
 Key overrideToKey(const SharedOverride &override)
 {
@@ -162,12 +196,16 @@ LayoutGroup::LayoutGroup()
 class InputMethodPrivate
 {
 public:
+    StartupTimeline timeline;
+    const bool single_window;
     QScopedPointer<QQuickView> surface;
+    // Not created in single window mode:
     QScopedPointer<QQuickView> extended_surface;
     QScopedPointer<QQuickView> magnifier_surface;
     Editor editor;
     DefaultFeedback feedback;
     SharedStyle style;
+    SharedImageCache image_cache;
     UpdateNotifier notifier;
     QMap<QString, SharedOverride> key_overrides;
     Settings settings;
@@ -175,25 +213,36 @@ public:
     LayoutGroup extended_layout;
     Model::Layout magnifier_layout;
     MaliitContext context;
+    LayoutWarmUp warm_up;
+    int overlay_headroom; //!< Room above the keyboard, in single window mode.
 
     explicit InputMethodPrivate(InputMethod * const q,
                                 MAbstractInputMethodHost *host);
     void setLayoutOrientation(Logic::LayoutHelper::Orientation orientation);
+    void updateOverlayHeadroom();
     void syncWordEngine(Logic::LayoutHelper::Orientation orientation);
 
     void connectToNotifier();
+    void setUpEngine(QQmlEngine *engine);
     void setContextProperties(QQmlContext *qml_context);
+    void loadOverlay(InputMethod *q,
+                     QQuickView *view,
+                     const QString &qml_file);
+    void finishOverlay(QQmlComponent *component);
 };
 
 
 InputMethodPrivate::InputMethodPrivate(InputMethod *const q,
                                        MAbstractInputMethodHost *host)
-    : surface(getSurface(host))
-    , extended_surface(getOverlaySurface(host, surface.data()))
-    , magnifier_surface(getOverlaySurface(host, surface.data()))
+    : timeline()
+    , single_window(singleWindowRequested())
+    , surface(getSurface(host))
+    , extended_surface(single_window ? 0 : getOverlaySurface(host, surface.data()))
+    , magnifier_surface(single_window ? 0 : getOverlaySurface(host, surface.data()))
     , editor(new Model::Text, new Logic::WordEngine, new Logic::LanguageFeatures)
     , feedback()
     , style(new Style)
+    , image_cache(new StyleImageCache(nativeRenderingRequested()))
     , notifier()
     , key_overrides()
     , settings()
@@ -201,7 +250,11 @@ InputMethodPrivate::InputMethodPrivate(InputMethod *const q,
     , extended_layout()
     , magnifier_layout()
     , context(q, style)
+    , warm_up()
+    , overlay_headroom(0)
 {
+    timeline.mark("surfaces, editor and models");
+
     editor.setHost(host);
 
 #ifndef DISABLE_PREEDIT
@@ -213,6 +266,10 @@ InputMethodPrivate::InputMethodPrivate(InputMethod *const q,
 
     layout.updater.setStyle(style);
     extended_layout.updater.setStyle(style);
+
+    // Both updaters load the same layouts into the shared caches, so only
+    // the main one prepares variants and prefetches:
+    layout.updater.setEagerVariantsEnabled(true);
     feedback.setStyle(style);
 
     const QSize &screen_size(QGuiApplication::primaryScreen()->availableSize());
@@ -226,24 +283,30 @@ InputMethodPrivate::InputMethodPrivate(InputMethod *const q,
 
     connectToNotifier();
 
-    // TODO: Figure out whether two views can share one engine.
-    QQmlEngine *const engine(surface->engine());
-    engine->addImportPath(MALIIT_KEYBOARD_DATA_DIR);
-    setContextProperties(engine->rootContext());
+    qmlRegisterType<KeyboardRenderer>("MaliitKeyboard", 1, 0, "KeyboardRenderer");
+    qmlRegisterType<KeyboardInputArea>("MaliitKeyboard", 1, 0, "KeyboardInputArea");
 
-    surface->setSource(QUrl::fromLocalFile(g_maliit_keyboard_qml));
+    // All surfaces share the decoded style images:
+    layout.model.setImageProvider(g_style_image_provider);
+    extended_layout.model.setImageProvider(g_style_image_provider);
+    magnifier_layout.setImageProvider(g_style_image_provider);
 
-    QQmlEngine *const extended_engine(extended_surface->engine());
-    extended_engine->addImportPath(MALIIT_KEYBOARD_DATA_DIR);
-    setContextProperties(extended_engine->rootContext());
+    setUpEngine(surface->engine());
 
-    extended_surface->setSource(QUrl::fromLocalFile(g_maliit_keyboard_extended_qml));
+    // The main surface is the only one needed for the first frame; extended
+    // keys and magnifier are loaded later, see InputMethod::loadDeferredStages():
+    surface->setSource(QUrl::fromLocalFile(single_window ? g_maliit_keyboard_single_qml
+                                                         : g_maliit_keyboard_qml));
+    timeline.mark("main surface");
 
-    QQmlEngine *const magnifier_engine(magnifier_surface->engine());
-    magnifier_engine->addImportPath(MALIIT_KEYBOARD_DATA_DIR);
-    setContextProperties(magnifier_engine->rootContext());
+    if (single_window) {
+        return;
+    }
 
-    magnifier_surface->setSource(QUrl::fromLocalFile(g_maliit_magnifier_qml));
+    // Each overlay surface is a QQuickView registered with the host and owns
+    // its own QML engine, so every engine needs the same setup:
+    setUpEngine(extended_surface->engine());
+    setUpEngine(magnifier_surface->engine());
 }
 
 
@@ -253,6 +316,30 @@ void InputMethodPrivate::setLayoutOrientation(Logic::LayoutHelper::Orientation o
     syncWordEngine(orientation);
     layout.updater.setOrientation(orientation);
     extended_layout.updater.setOrientation(orientation);
+    updateOverlayHeadroom();
+}
+
+
+//! In single window mode, the extended keys and the magnifier of a top row
+//! key reach above the keyboard, by up to the style's vertical offset. The
+//! surface keeps that much room above the keyboard for them.
+void InputMethodPrivate::updateOverlayHeadroom()
+{
+    if (not single_window) {
+        return;
+    }
+
+    const qreal vertical_offset(style->attributes()
+                                ? style->attributes()->verticalOffset(layout.helper.orientation())
+                                : 0);
+    // The magnifier is scaled, the extended keys are not:
+    const int headroom(qCeil(vertical_offset * qMax<qreal>(1.0, layout.model.scaleRatio())));
+
+    if (overlay_headroom != headroom) {
+        overlay_headroom = headroom;
+        surface->rootContext()->setContextProperty("maliit_overlay_headroom", overlay_headroom);
+        surface->setHeight(layout.model.height() + overlay_headroom);
+    }
 }
 
 
@@ -281,6 +368,14 @@ void InputMethodPrivate::connectToNotifier()
                      &layout.helper, SLOT(onKeysOverriden(Logic::KeyOverrides, bool)));
 }
 
+void InputMethodPrivate::setUpEngine(QQmlEngine *engine)
+{
+    engine->addImportPath(MALIIT_KEYBOARD_DATA_DIR);
+    // The engine takes ownership of the provider, not of the shared cache:
+    engine->addImageProvider(g_style_image_provider, new StyleImageProvider(image_cache));
+    setContextProperties(engine->rootContext());
+}
+
 void InputMethodPrivate::setContextProperties(QQmlContext *qml_context)
 {
     qml_context->setContextProperty("maliit", &context);
@@ -289,8 +384,56 @@ void InputMethodPrivate::setContextProperties(QQmlContext *qml_context)
     qml_context->setContextProperty("maliit_extended_layout", &extended_layout.model);
     qml_context->setContextProperty("maliit_extended_event_handler", &extended_layout.event_handler);
     qml_context->setContextProperty("maliit_magnifier_layout", &magnifier_layout);
+    qml_context->setContextProperty("maliit_native_rendering", nativeRenderingRequested());
+    qml_context->setContextProperty("maliit_native_input", nativeInputRequested());
+    qml_context->setContextProperty("maliit_overlay_headroom", overlay_headroom);
+}
+
+//! \brief Compiles the root item of an overlay surface in the background.
+void InputMethodPrivate::loadOverlay(InputMethod *q,
+                                     QQuickView *view,
+                                     const QString &qml_file)
+{
+    QQmlComponent *const component(new QQmlComponent(view->engine(), QUrl::fromLocalFile(qml_file),
+                                                     QQmlComponent::Asynchronous, view));
+
+    if (component->isLoading()) {
+        QObject::connect(component, SIGNAL(statusChanged(QQmlComponent::Status)),
+                         q,         SLOT(onOverlayStatusChanged()));
+    } else {
+        finishOverlay(component);
+    }
+}
+
+
+//! \brief Creates the overlay's root item, once its component is loaded,
+//!        and puts it into the overlay surface.
+void InputMethodPrivate::finishOverlay(QQmlComponent *component)
+{
+    if (component->isLoading()) {
+        return;
+    }
+
+    QQuickView *const view(qobject_cast<QQuickView *>(component->parent()));
+    QObject *const object(component->isReady() ? component->create() : 0);
+    QQuickItem *const item(qobject_cast<QQuickItem *>(object));
+
+    if (view and item) {
+        item->setParent(view);
+        item->setParentItem(view->contentItem());
+        timeline.markDone(view == extended_surface.data() ? "extended keys surface"
+                                                          : "magnifier surface");
+    } else {
+        qWarning() << __PRETTY_FUNCTION__
+                   << "Cannot create overlay" << component->url()
+                   << component->errors();
+        delete object;
+    }
+
+    component->deleteLater();
 }
 
+
 InputMethod::InputMethod(MAbstractInputMethodHost *host)
     : MAbstractInputMethod(host)
     , d_ptr(new InputMethodPrivate(this, host))
@@ -322,27 +465,37 @@ InputMethod::InputMethod(MAbstractInputMethodHost *host)
     connect(&d->layout.updater, SIGNAL(keyboardTitleChanged(QString)),
             &d->layout.model,   SLOT(setTitle(QString)));
 
-    connect(&d->extended_layout.model, SIGNAL(widthChanged(int)),
-            this,                      SLOT(onExtendedLayoutWidthChanged(int)));
+    // In single window mode, extended keys and magnifier are overlay items
+    // that follow their models by themselves:
+    if (not d->single_window) {
+        connect(&d->extended_layout.model, SIGNAL(widthChanged(int)),
+                this,                      SLOT(onExtendedLayoutWidthChanged(int)));
 
-    connect(&d->extended_layout.model, SIGNAL(heightChanged(int)),
-            this,                      SLOT(onExtendedLayoutHeightChanged(int)));
+        connect(&d->extended_layout.model, SIGNAL(heightChanged(int)),
+                this,                      SLOT(onExtendedLayoutHeightChanged(int)));
 
-    connect(&d->extended_layout.model, SIGNAL(originChanged(QPoint)),
-            this,                      SLOT(onExtendedLayoutOriginChanged(QPoint)));
+        connect(&d->extended_layout.model, SIGNAL(originChanged(QPoint)),
+                this,                      SLOT(onExtendedLayoutOriginChanged(QPoint)));
 
-    connect(&d->magnifier_layout, SIGNAL(widthChanged(int)),
-            this,                 SLOT(onMagnifierLayoutWidthChanged(int)));
+        connect(&d->magnifier_layout, SIGNAL(widthChanged(int)),
+                this,                 SLOT(onMagnifierLayoutWidthChanged(int)));
 
-    connect(&d->magnifier_layout, SIGNAL(heightChanged(int)),
-            this,                 SLOT(onMagnifierLayoutHeightChanged(int)));
+        connect(&d->magnifier_layout, SIGNAL(heightChanged(int)),
+                this,                 SLOT(onMagnifierLayoutHeightChanged(int)));
 
-    connect(&d->magnifier_layout, SIGNAL(originChanged(QPoint)),
-            this,                 SLOT(onMagnifierLayoutOriginChanged(QPoint)));
+        connect(&d->magnifier_layout, SIGNAL(originChanged(QPoint)),
+                this,                 SLOT(onMagnifierLayoutOriginChanged(QPoint)));
+    }
 
     // FIXME: Reimplement keyboardClosed, switchLeft and switchRight
     // (triggered by glass).
 
+    connect(d->editor.wordEngine(), SIGNAL(backendsReady()),
+            this,                   SLOT(onWordEngineBackendsReady()));
+
+    connect(&d->warm_up, SIGNAL(finished()),
+            this,        SLOT(onLayoutWarmUpFinished()));
+
     connect(&d->editor, SIGNAL(rightLayoutSelected()),
             this,       SLOT(onRightLayoutSelected()));
 
@@ -356,6 +509,7 @@ InputMethod::InputMethod(MAbstractInputMethodHost *host)
     registerWordEngineSetting(host);
     registerHideWordRibbonInPortraitModeSetting(host);
     registerAutoRepeatBehaviour(host);
+    d->timeline.mark("settings");
 
     // Setting layout orientation depends on word engine and hide word ribbon
     // settings to be initialized first:
@@ -366,6 +520,9 @@ InputMethod::InputMethod(MAbstractInputMethodHost *host)
 
     d->setLayoutOrientation(screen_size.width() >= screen_size.height()
                             ? Logic::LayoutHelper::Landscape : Logic::LayoutHelper::Portrait);
+    d->timeline.mark("active layout");
+
+    QTimer::singleShot(0, this, SLOT(loadDeferredStages()));
 }
 
 InputMethod::~InputMethod()
@@ -378,15 +535,21 @@ void InputMethod::show()
     const QRect &rect = d->surface->screen()->availableGeometry();
 
     d->layout.model.setScaleRatio(rect.width() / (d->layout.model.width() / d->layout.model.scaleRatio()));
+    d->updateOverlayHeadroom();
+
+    const int height(d->layout.model.height() + d->overlay_headroom);
 
     d->surface->setGeometry(QRect(QPoint(rect.x() + (rect.width() - d->layout.model.width()) / 2,
-                                         rect.y() + rect.height() - d->layout.model.height()),
+                                         rect.y() + rect.height() - height),
                                   QSize(d->layout.model.width(),
-                                        d->layout.model.height())));
+                                        height)));
 
     d->surface->show();
-    d->extended_surface->show();
-    d->magnifier_surface->show();
+
+    if (not d->single_window) {
+        d->extended_surface->show();
+        d->magnifier_surface->show();
+    }
 }
 
 void InputMethod::hide()
@@ -395,8 +558,11 @@ void InputMethod::hide()
     d->layout.updater.resetOnKeyboardClosed();
     d->editor.clearPreedit();
     d->surface->hide();
-    d->extended_surface->hide();
-    d->magnifier_surface->hide();
+
+    if (not d->single_window) {
+        d->extended_surface->hide();
+        d->magnifier_surface->hide();
+    }
 }
 
 void InputMethod::setPreedit(const QString &preedit,
@@ -441,6 +607,9 @@ void InputMethod::setActiveSubView(const QString &id,
     // FIXME: Perhaps better to let both LayoutUpdater share the same KeyboardLoader instance?
     d->layout.updater.setActiveKeyboardId(id);
     d->extended_layout.updater.setActiveKeyboardId(id);
+
+    // Asks the host for the new neighbours once it is done switching:
+    QTimer::singleShot(0, this, SLOT(prefetchSurroundingLayouts()));
 }
 
 QString InputMethod::activeSubView(Maliit::HandlerState state) const
@@ -617,6 +786,60 @@ void InputMethod::registerAutoRepeatBehaviour(MAbstractInputMethodHost *host)
 }
 
 
+//! \brief Starts everything not needed for the first frame: the overlay
+//!        surfaces, prefetching the layouts next to the active one, and the
+//!        opt-in layout warm-up.
+void InputMethod::loadDeferredStages()
+{
+    Q_D(InputMethod);
+
+    if (not d->single_window) {
+        d->loadOverlay(this, d->extended_surface.data(), g_maliit_keyboard_extended_qml);
+        d->loadOverlay(this, d->magnifier_surface.data(), g_maliit_magnifier_qml);
+    }
+
+    prefetchSurroundingLayouts();
+    d->warm_up.start(LayoutWarmUp::idsFromEnvironment(d->layout.updater.keyboardIds()));
+    d->timeline.mark("deferred stages started");
+}
+
+void InputMethod::onOverlayStatusChanged()
+{
+    Q_D(InputMethod);
+    QQmlComponent *const component(qobject_cast<QQmlComponent *>(sender()));
+
+    if (component) {
+        d->finishOverlay(component);
+    }
+}
+
+void InputMethod::onWordEngineBackendsReady()
+{
+    Q_D(InputMethod);
+    d->timeline.markDone("word engine backends");
+}
+
+void InputMethod::onLayoutWarmUpFinished()
+{
+    Q_D(InputMethod);
+    d->timeline.markDone("layout warm-up");
+}
+
+//! \brief Prepares the layouts onLeftLayoutSelected() and
+//!        onRightLayoutSelected() switch to.
+void InputMethod::prefetchSurroundingLayouts()
+{
+    Q_D(InputMethod);
+    QStringList ids;
+
+    Q_FOREACH (const MImSubViewDescription &description,
+               inputMethodHost()->surroundingSubViewDescriptions(Maliit::OnScreen)) {
+        ids.append(description.id());
+    }
+
+    d->layout.updater.prefetchKeyboards(ids);
+}
+
 void InputMethod::onLeftLayoutSelected()
 {
     // This API smells real bad.
@@ -656,9 +879,19 @@ void InputMethod::onStyleSettingChanged()
 {
     Q_D(InputMethod);
     d->style->setProfile(d->settings.style->value().toString());
+
+    const ImageAtlas atlas(d->style->attributes() ? d->style->attributes()->imageAtlas()
+                                                  : ImageAtlas());
+    // Also prepares the atlas for KeyboardRenderer, before the first frame:
+    d->image_cache->preload(d->style->directory(Style::Images), atlas);
     d->layout.model.setImageDirectory(d->style->directory(Style::Images));
     d->extended_layout.model.setImageDirectory(d->style->directory(Style::Images));
     d->magnifier_layout.setImageDirectory(d->style->directory(Style::Images));
+
+    d->layout.model.setImageAtlas(atlas);
+    d->extended_layout.model.setImageAtlas(atlas);
+    d->magnifier_layout.setImageAtlas(atlas);
+    d->updateOverlayHeadroom();
 }
 
 void InputMethod::onKeyboardClosed()
@@ -764,7 +997,7 @@ void InputMethod::onLayoutWidthChanged(int width)
 void InputMethod::onLayoutHeightChanged(int height)
 {
     Q_D(InputMethod);
-    d->surface->setHeight(height);
+    d->surface->setHeight(height + d->overlay_headroom);
 }
 
 void InputMethod::onExtendedLayoutWidthChanged(int width)
@@ -82,6 +82,12 @@ private:
     void registerHideWordRibbonInPortraitModeSetting(MAbstractInputMethodHost *host);
     void registerAutoRepeatBehaviour(MAbstractInputMethodHost *host);
 
+    Q_SLOT void loadDeferredStages();
+    Q_SLOT void onOverlayStatusChanged();
+    Q_SLOT void onWordEngineBackendsReady();
+    Q_SLOT void onLayoutWarmUpFinished();
+    Q_SLOT void prefetchSurroundingLayouts();
+
     Q_SLOT void onScreenSizeChange(const QRect &rect);
     Q_SLOT void onStyleSettingChanged();
     Q_SLOT void onKeyboardClosed();
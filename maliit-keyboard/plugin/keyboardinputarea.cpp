@@ -0,0 +1,434 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012-2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "keyboardinputarea.h"
+
+#include "models/layout.h"
+#include "logic/eventhandler.h"
+
+namespace MaliitKeyboard {
+namespace {
+
+// Flicks only count right after a press, as in Keyboard.qml:
+const int FlickTimeout = 500;
+const qreal FlickDownDistance = 0.3; // of the item height
+const qreal FlickSidewaysDistance = 0.2; // of the item width
+
+// Touch point ids are non-negative, so the mouse gets its own id:
+const int MousePointId = -1;
+
+struct PointState
+{
+    int key; //!< Index of the pressed key.
+    bool inside; //!< Whether the point is still on the pressed key.
+    bool flicked;
+    int hold_timer;
+    QPointF start;
+    QElapsedTimer elapsed;
+
+    explicit PointState()
+        : key(-1)
+        , inside(false)
+        , flicked(false)
+        , hold_timer(0)
+        , start()
+        , elapsed()
+    {}
+};
+
+} // namespace
+
+
+class KeyboardInputAreaPrivate
+{
+public:
+    KeyboardInputArea *const q;
+    QPointer<Model::Layout> layout;
+    QPointer<Logic::EventHandler> event_handler;
+    QHash<int, PointState> points;
+    int hovered_key;
+
+    explicit KeyboardInputAreaPrivate(KeyboardInputArea *area);
+
+    bool press(int id,
+               const QPointF &pos);
+    void move(int id,
+              const QPointF &pos);
+    void release(int id,
+                 const QPointF &pos);
+    void cancel();
+    void hover(int key);
+};
+
+
+KeyboardInputAreaPrivate::KeyboardInputAreaPrivate(KeyboardInputArea *area)
+    : q(area)
+    , layout()
+    , event_handler()
+    , points()
+    , hovered_key(-1)
+{}
+
+
+//! Returns whether pos hit a key.
+bool KeyboardInputAreaPrivate::press(int id,
+                                     const QPointF &pos)
+{
+    if (not layout || not event_handler) {
+        return false;
+    }
+
+    const int key(layout->keyIndexAt(pos));
+
+    if (key < 0) {
+        return false;
+    }
+
+    PointState state;
+    state.key = key;
+    state.inside = true;
+    state.start = pos;
+    state.elapsed.start();
+    state.hold_timer = q->startTimer(QGuiApplication::styleHints()->mousePressAndHoldInterval());
+    points.insert(id, state);
+
+    // A hovering mouse already entered the key:
+    if (id == MousePointId && hovered_key >= 0) {
+        if (hovered_key != key) {
+            event_handler->onExited(hovered_key);
+            event_handler->onEntered(key);
+        }
+
+        hovered_key = -1;
+    } else {
+        event_handler->onEntered(key);
+    }
+
+    event_handler->onPressed(key);
+    return true;
+}
+
+
+void KeyboardInputAreaPrivate::move(int id,
+                                    const QPointF &pos)
+{
+    const QHash<int, PointState>::iterator it(points.find(id));
+
+    if (it == points.end() || not layout || not event_handler) {
+        return;
+    }
+
+    PointState &state(it.value());
+
+    // Like a per-key MouseArea, a point stays with the key it pressed:
+    const bool inside(layout->keyIndexAt(pos) == state.key);
+
+    if (inside != state.inside) {
+        state.inside = inside;
+
+        if (inside) {
+            event_handler->onEntered(state.key);
+        } else {
+            event_handler->onExited(state.key);
+        }
+    }
+
+    if (state.flicked || state.elapsed.elapsed() >= FlickTimeout) {
+        return;
+    }
+
+    const QPointF distance(pos - state.start);
+
+    if (distance.y() > q->height() * FlickDownDistance) {
+        state.flicked = true;
+        Q_EMIT q->flickedDown();
+    } else if (distance.x() > q->width() * FlickSidewaysDistance) {
+        state.flicked = true;
+        Q_EMIT q->flickedRight();
+    } else if (-distance.x() > q->width() * FlickSidewaysDistance) {
+        state.flicked = true;
+        Q_EMIT q->flickedLeft();
+    }
+}
+
+
+void KeyboardInputAreaPrivate::release(int id,
+                                       const QPointF &pos)
+{
+    if (not points.contains(id)) {
+        return;
+    }
+
+    const PointState state(points.take(id));
+
+    if (state.hold_timer) {
+        q->killTimer(state.hold_timer);
+    }
+
+    if (not event_handler) {
+        return;
+    }
+
+    event_handler->onReleased(state.key);
+
+    if (id == MousePointId) {
+        // The mouse keeps hovering:
+        hovered_key = state.inside ? state.key : -1;
+        hover(layout ? layout->keyIndexAt(pos) : -1);
+    } else if (state.inside) {
+        event_handler->onExited(state.key);
+    }
+}
+
+
+void KeyboardInputAreaPrivate::cancel()
+{
+    for (QHash<int, PointState>::const_iterator it = points.constBegin();
+         it != points.constEnd();
+         ++it) {
+        const PointState &state(it.value());
+
+        if (state.hold_timer) {
+            q->killTimer(state.hold_timer);
+        }
+
+        if (state.inside && event_handler) {
+            event_handler->onExited(state.key);
+        }
+    }
+
+    points.clear();
+}
+
+
+//! Moves the hovering mouse onto key, or off all keys if key is -1.
+void KeyboardInputAreaPrivate::hover(int key)
+{
+    if (points.contains(MousePointId) || not event_handler) {
+        return;
+    }
+
+    if (key == hovered_key) {
+        return;
+    }
+
+    if (hovered_key >= 0) {
+        event_handler->onExited(hovered_key);
+    }
+
+    if (key >= 0) {
+        event_handler->onEntered(key);
+    }
+
+    hovered_key = key;
+}
+
+
+KeyboardInputArea::KeyboardInputArea(QQuickItem *parent)
+    : QQuickItem(parent)
+    , d_ptr(new KeyboardInputAreaPrivate(this))
+{
+    setAcceptedMouseButtons(Qt::LeftButton);
+    setAcceptHoverEvents(true);
+}
+
+
+KeyboardInputArea::~KeyboardInputArea()
+{}
+
+
+QObject *KeyboardInputArea::layout() const
+{
+    Q_D(const KeyboardInputArea);
+    return d->layout.data();
+}
+
+
+//! \brief Sets the Model::Layout instance used to find keys.
+void KeyboardInputArea::setLayout(QObject *layout)
+{
+    Q_D(KeyboardInputArea);
+    Model::Layout *const model(qobject_cast<Model::Layout *>(layout));
+
+    if (layout && not model) {
+        qWarning() << __PRETTY_FUNCTION__
+                   << "Not a keyboard layout model:" << layout;
+    }
+
+    if (d->layout.data() != model) {
+        d->cancel();
+        d->hovered_key = -1;
+        d->layout = model;
+        Q_EMIT layoutChanged(model);
+    }
+}
+
+
+QObject *KeyboardInputArea::eventHandler() const
+{
+    Q_D(const KeyboardInputArea);
+    return d->event_handler.data();
+}
+
+
+//! \brief Sets the Logic::EventHandler instance that receives key events.
+void KeyboardInputArea::setEventHandler(QObject *event_handler)
+{
+    Q_D(KeyboardInputArea);
+    Logic::EventHandler *const handler(qobject_cast<Logic::EventHandler *>(event_handler));
+
+    if (event_handler && not handler) {
+        qWarning() << __PRETTY_FUNCTION__
+                   << "Not an event handler:" << event_handler;
+    }
+
+    if (d->event_handler.data() != handler) {
+        d->cancel();
+        d->hovered_key = -1;
+        d->event_handler = handler;
+        Q_EMIT eventHandlerChanged(handler);
+    }
+}
+
+
+void KeyboardInputArea::touchEvent(QTouchEvent *event)
+{
+    Q_D(KeyboardInputArea);
+
+    if (event->type() == QEvent::TouchCancel) {
+        d->cancel();
+        event->accept();
+        return;
+    }
+
+    bool accepted(false);
+
+    Q_FOREACH (const QTouchEvent::TouchPoint &point, event->touchPoints()) {
+        switch (point.state()) {
+        case Qt::TouchPointPressed:
+            accepted |= d->press(point.id(), point.pos());
+            break;
+
+        case Qt::TouchPointMoved:
+            d->move(point.id(), point.pos());
+            accepted = true;
+            break;
+
+        case Qt::TouchPointReleased:
+            d->release(point.id(), point.pos());
+            accepted = true;
+            break;
+
+        default:
+            accepted |= d->points.contains(point.id());
+            break;
+        }
+    }
+
+    event->setAccepted(accepted);
+}
+
+
+void KeyboardInputArea::mousePressEvent(QMouseEvent *event)
+{
+    Q_D(KeyboardInputArea);
+    event->setAccepted(d->press(MousePointId, event->localPos()));
+}
+
+
+void KeyboardInputArea::mouseMoveEvent(QMouseEvent *event)
+{
+    Q_D(KeyboardInputArea);
+    d->move(MousePointId, event->localPos());
+}
+
+
+void KeyboardInputArea::mouseReleaseEvent(QMouseEvent *event)
+{
+    Q_D(KeyboardInputArea);
+    d->release(MousePointId, event->localPos());
+}
+
+
+void KeyboardInputArea::mouseUngrabEvent()
+{
+    Q_D(KeyboardInputArea);
+    d->cancel();
+}
+
+
+void KeyboardInputArea::touchUngrabEvent()
+{
+    Q_D(KeyboardInputArea);
+    d->cancel();
+}
+
+
+void KeyboardInputArea::hoverMoveEvent(QHoverEvent *event)
+{
+    Q_D(KeyboardInputArea);
+    d->hover(d->layout ? d->layout->keyIndexAt(event->posF()) : -1);
+}
+
+
+void KeyboardInputArea::hoverLeaveEvent(QHoverEvent *event)
+{
+    Q_UNUSED(event)
+    Q_D(KeyboardInputArea);
+    d->hover(-1);
+}
+
+
+void KeyboardInputArea::timerEvent(QTimerEvent *event)
+{
+    Q_D(KeyboardInputArea);
+
+    for (QHash<int, PointState>::iterator it = d->points.begin();
+         it != d->points.end();
+         ++it) {
+        PointState &state(it.value());
+
+        if (state.hold_timer == event->timerId()) {
+            killTimer(state.hold_timer);
+            state.hold_timer = 0;
+
+            if (state.inside && d->event_handler) {
+                d->event_handler->onPressAndHold(state.key);
+            }
+
+            return;
+        }
+    }
+
+    QQuickItem::timerEvent(event);
+}
+
+} // namespace MaliitKeyboard
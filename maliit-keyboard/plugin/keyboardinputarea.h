@@ -0,0 +1,95 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012-2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef MALIIT_KEYBOARD_KEYBOARDINPUTAREA_H
+#define MALIIT_KEYBOARD_KEYBOARDINPUTAREA_H
+
+#include <QtQuick>
+
+namespace MaliitKeyboard {
+
+class KeyboardInputAreaPrivate;
+
+//! \brief Dispatches mouse and touch input for all keys of a Model::Layout.
+//!
+//! Replaces the per-key MouseArea delegates of Keyboard.qml. Keys are found
+//! through Model::Layout::keyIndexAt(), and Logic::EventHandler is called
+//! directly. Every touch point is tracked on its own, so that several keys can
+//! be pressed at the same time.
+class KeyboardInputArea
+    : public QQuickItem
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(KeyboardInputArea)
+    Q_DECLARE_PRIVATE(KeyboardInputArea)
+
+    Q_PROPERTY(QObject *layout READ layout
+                               WRITE setLayout
+                               NOTIFY layoutChanged)
+    Q_PROPERTY(QObject *event_handler READ eventHandler
+                                      WRITE setEventHandler
+                                      NOTIFY eventHandlerChanged)
+
+public:
+    explicit KeyboardInputArea(QQuickItem *parent = 0);
+    virtual ~KeyboardInputArea();
+
+    QObject *layout() const;
+    void setLayout(QObject *layout);
+    Q_SIGNAL void layoutChanged(QObject *changed);
+
+    QObject *eventHandler() const;
+    void setEventHandler(QObject *event_handler);
+    Q_SIGNAL void eventHandlerChanged(QObject *changed);
+
+    // Quick flicks right after a press:
+    Q_SIGNAL void flickedDown();
+    Q_SIGNAL void flickedLeft();
+    Q_SIGNAL void flickedRight();
+
+protected:
+    virtual void touchEvent(QTouchEvent *event);
+    virtual void mousePressEvent(QMouseEvent *event);
+    virtual void mouseMoveEvent(QMouseEvent *event);
+    virtual void mouseReleaseEvent(QMouseEvent *event);
+    virtual void mouseUngrabEvent();
+    virtual void touchUngrabEvent();
+    virtual void hoverMoveEvent(QHoverEvent *event);
+    virtual void hoverLeaveEvent(QHoverEvent *event);
+    virtual void timerEvent(QTimerEvent *event);
+
+private:
+    const QScopedPointer<KeyboardInputAreaPrivate> d_ptr;
+};
+
+} // namespace MaliitKeyboard
+
+#endif // MALIIT_KEYBOARD_KEYBOARDINPUTAREA_H
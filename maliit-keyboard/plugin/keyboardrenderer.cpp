@@ -0,0 +1,858 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012-2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "keyboardrenderer.h"
+#include "styleimageprovider.h"
+
+#include "models/layout.h"
+#include "models/key.h"
+#include "models/font.h"
+#include "models/imageatlas.h"
+
+namespace MaliitKeyboard {
+namespace {
+
+// A nine-patch consists of nine quads, of two triangles each.
+const int VerticesPerKey = 9 * 6;
+
+// Label textures kept beyond the ones shown, e.g. for toggling shift.
+const int MaxUnusedLabels = 128;
+
+//! Whether the scene graph can only render its own node types, as is the case
+//! for the software backend. Custom geometry nodes are ignored there.
+bool useTextureNodesOnly()
+{
+#if QT_VERSION >= QT_VERSION_CHECK(5, 8, 0)
+    return (QQuickWindow::sceneGraphBackend() == QLatin1String("software"));
+#else
+    return false;
+#endif
+}
+
+QString imagePath(const QString &directory,
+                  const QByteArray &base_name)
+{
+    if (directory.isEmpty() || base_name.isEmpty()) {
+        return QString();
+    }
+
+    return QString(directory + "/" + base_name);
+}
+
+//! Returns the image cache behind the style image provider of the item's
+//! QML engine, see InputMethodPrivate::setUpEngine().
+SharedImageCache imageCache(const QQuickItem *item,
+                            const QString &provider_id)
+{
+    QQmlEngine *const engine(qmlEngine(item));
+
+    if (not engine || provider_id.isEmpty()) {
+        return SharedImageCache();
+    }
+
+    const StyleImageProvider *const provider(
+        dynamic_cast<StyleImageProvider *>(engine->imageProvider(provider_id)));
+
+    return (provider ? provider->cache() : SharedImageCache());
+}
+
+//! Computes the four edges of a nine-patch along one axis. Borders that do
+//! not fit are shrunk proportionally.
+void sliceEdges(qreal begin,
+                qreal end,
+                qreal first_border,
+                qreal last_border,
+                qreal *edges)
+{
+    const qreal length(end - begin);
+    const qreal borders(first_border + last_border);
+
+    if (borders > length && borders > 0) {
+        first_border *= length / borders;
+        last_border *= length / borders;
+    }
+
+    edges[0] = begin;
+    edges[1] = begin + first_border;
+    edges[2] = end - last_border;
+    edges[3] = end;
+}
+
+//! An image, as part of a texture that possibly holds other images, too.
+struct ImageRef
+{
+    QSGTexture *texture;
+    QRect source; //!< Image rectangle, in texture pixels.
+
+    explicit ImageRef()
+        : texture(0)
+        , source()
+    {}
+};
+
+struct KeySlot
+{
+    QByteArray background; //!< Base name of the background image.
+    ImageRef background_image;
+    QRectF rect; //!< Background rectangle, in item coordinates.
+    QRectF borders; //!< Background borders, left, top, right and bottom
+                    //!< stored as x, y, width and height (like the model).
+    QSGNode *patches; //!< Background, if rendered through texture nodes.
+    QSGSimpleTextureNode *label;
+    QSGSimpleTextureNode *icon;
+
+    explicit KeySlot()
+        : background()
+        , background_image()
+        , rect()
+        , borders()
+        , patches(0)
+        , label(0)
+        , icon(0)
+    {}
+};
+
+//! Draws the backgrounds of all keys whose background images share a
+//! texture. With an image atlas, that is all keys.
+class BackgroundBatch
+    : public QSGGeometryNode
+{
+public:
+    QVector<int> keys; //!< Key indices, in vertex order.
+    bool rebuild;
+
+    explicit BackgroundBatch(QSGTexture *texture)
+        : keys()
+        , rebuild(true)
+    {
+        QSGGeometry *geometry(new QSGGeometry(QSGGeometry::defaultAttributes_TexturedPoint2D(), 0));
+        geometry->setDrawingMode(GL_TRIANGLES);
+        setGeometry(geometry);
+        setFlag(QSGNode::OwnsGeometry);
+
+        QSGTextureMaterial *material(new QSGTextureMaterial);
+        material->setTexture(texture);
+        material->setFiltering(QSGTexture::Linear);
+        setMaterial(material);
+        setFlag(QSGNode::OwnsMaterial);
+    }
+
+    QSGTexture *texture() const
+    {
+        return static_cast<QSGTextureMaterial *>(material())->texture();
+    }
+};
+
+//! Root node of a KeyboardRenderer. Owns all textures, which are shared
+//! between keys and kept across key area changes. Label textures no key
+//! shows are only kept up to a bound, see pruneLabels().
+//!
+//! Images are taken from the style's image atlas, as prepared by the shared
+//! StyleImageCache. Images missing from the atlas, or all images if there
+//! is no cache, get a texture of their own.
+class KeyboardNode
+    : public QSGNode
+{
+private:
+    QQuickWindow *const m_window;
+    const SharedImageCache m_image_cache;
+    const bool m_texture_nodes_only;
+    QSGNode *const m_backgrounds;
+    QSGNode *const m_contents;
+    QVector<KeySlot> m_slots;
+    QHash<QSGTexture *, BackgroundBatch *> m_batches;
+    QString m_image_directory;
+    ImageAtlas m_style_atlas; //!< As given by the model, can be invalid.
+    ImageAtlas m_atlas; //!< In use, as given by the image cache.
+    bool m_atlas_loaded;
+    QSGTexture *m_atlas_texture;
+    QHash<QByteArray, ImageRef> m_images;
+    QList<QSGTexture *> m_image_textures; //!< Atlas and single image textures.
+    QHash<QString, QSGTexture *> m_labels;
+
+public:
+    explicit KeyboardNode(QQuickWindow *window,
+                          const SharedImageCache &image_cache);
+    virtual ~KeyboardNode();
+
+    bool setImages(const QString &image_directory,
+                   const ImageAtlas &atlas);
+    void setKeyCount(int count);
+    void updateKey(int index,
+                   const Key &key,
+                   qreal scale);
+    void updateBatches();
+    void pruneLabels();
+
+private:
+    ImageRef image(const QByteArray &base_name);
+    QSGTexture *atlasTexture();
+    QSGTexture *labelTexture(const QString &text,
+                             const Font &font,
+                             const QSize &size);
+    void releaseKey(int index);
+    void writeVertices(BackgroundBatch *batch,
+                       int position);
+    void updatePatches(KeySlot *slot);
+    void updateTextureNode(QSGSimpleTextureNode **node,
+                           QSGTexture *texture,
+                           const QRectF &rect,
+                           const QRectF &source = QRectF());
+};
+
+KeyboardNode::KeyboardNode(QQuickWindow *window,
+                           const SharedImageCache &image_cache)
+    : m_window(window)
+    , m_image_cache(image_cache)
+    , m_texture_nodes_only(useTextureNodesOnly())
+    , m_backgrounds(new QSGNode)
+    , m_contents(new QSGNode)
+    , m_slots()
+    , m_batches()
+    , m_image_directory()
+    , m_style_atlas()
+    , m_atlas()
+    , m_atlas_loaded(false)
+    , m_atlas_texture(0)
+    , m_images()
+    , m_image_textures()
+    , m_labels()
+{
+    appendChildNode(m_backgrounds);
+    appendChildNode(m_contents);
+}
+
+KeyboardNode::~KeyboardNode()
+{
+    // Child nodes are deleted by QSGNode, and do not own their textures.
+    qDeleteAll(m_image_textures);
+    qDeleteAll(m_labels);
+}
+
+//! Switches to the images of another style. Returns whether all keys need
+//! to be updated, as their images are gone.
+bool KeyboardNode::setImages(const QString &image_directory,
+                             const ImageAtlas &atlas)
+{
+    if (m_image_directory == image_directory && m_style_atlas == atlas) {
+        return false;
+    }
+
+    for (QHash<QSGTexture *, BackgroundBatch *>::iterator it = m_batches.begin();
+         it != m_batches.end();
+         ++it) {
+        m_backgrounds->removeChildNode(it.value());
+        delete it.value();
+    }
+
+    m_batches.clear();
+
+    for (int index = 0; index < m_slots.count(); ++index) {
+        m_slots[index].background.clear();
+        m_slots[index].background_image = ImageRef();
+    }
+
+    qDeleteAll(m_image_textures);
+    m_image_textures.clear();
+    m_images.clear();
+
+    m_image_directory = image_directory;
+    m_style_atlas = atlas;
+    m_atlas = ImageAtlas();
+    m_atlas_loaded = false;
+    m_atlas_texture = 0;
+
+    return true;
+}
+
+void KeyboardNode::setKeyCount(int count)
+{
+    for (int index = count; index < m_slots.count(); ++index) {
+        releaseKey(index);
+    }
+
+    m_slots.resize(count);
+}
+
+void KeyboardNode::updateKey(int index,
+                             const Key &key,
+                             qreal scale)
+{
+    KeySlot &slot(m_slots[index]);
+
+    // Same geometry as the BorderImage in Keyboard.qml, see Model::Layout::data.
+    const QRect &r(key.rect());
+    const QMargins &m(key.margins());
+    const QRectF rect((r.x() + m.left()) * scale, (r.y() + m.top()) * scale,
+                      (r.width() - m.left() - m.right()) * scale,
+                      (r.height() - m.top() - m.bottom()) * scale);
+
+    const QMargins &b(key.backgroundBorders());
+    const QRectF borders(b.left() * scale, b.top() * scale,
+                         b.right() * scale, b.bottom() * scale);
+    const QByteArray &background(key.background());
+
+    if (slot.background != background) {
+        const ImageRef background_image(image(background));
+        BackgroundBatch *const old_batch(m_batches.value(slot.background_image.texture));
+        BackgroundBatch *batch(m_texture_nodes_only ? 0 : m_batches.value(background_image.texture));
+
+        if (old_batch && old_batch != batch) {
+            old_batch->keys.removeOne(index);
+            old_batch->rebuild = true;
+        }
+
+        slot.background = background;
+        slot.background_image = background_image;
+        slot.rect = rect;
+        slot.borders = borders;
+
+        if (batch && batch == old_batch) {
+            // Same atlas texture, only the key's texture coordinates change:
+            if (not batch->rebuild) {
+                writeVertices(batch, batch->keys.indexOf(index));
+                batch->markDirty(QSGNode::DirtyGeometry);
+            }
+        } else if (background_image.texture && not m_texture_nodes_only) {
+            if (not batch) {
+                batch = new BackgroundBatch(background_image.texture);
+                m_batches.insert(background_image.texture, batch);
+                m_backgrounds->appendChildNode(batch);
+            }
+
+            batch->keys.append(index);
+            batch->rebuild = true;
+        }
+    } else if (slot.rect != rect || slot.borders != borders) {
+        slot.rect = rect;
+        slot.borders = borders;
+
+        BackgroundBatch *const batch(m_batches.value(slot.background_image.texture));
+
+        // Keys keep their place in the batch, so only their vertices change:
+        if (batch && not batch->rebuild) {
+            writeVertices(batch, batch->keys.indexOf(index));
+            batch->markDirty(QSGNode::DirtyGeometry);
+        }
+    }
+
+    if (m_texture_nodes_only) {
+        updatePatches(&slot);
+    }
+
+    const QString &text(key.labelText());
+    updateTextureNode(&slot.label,
+                      text.isEmpty() ? 0 : labelTexture(text, key.labelFont(), rect.size().toSize()),
+                      rect);
+
+    const ImageRef icon(image(key.icon()));
+    QRectF icon_rect;
+
+    if (icon.texture) {
+        // Centered at natural size, like the Image in Keyboard.qml:
+        const QSize &size(icon.source.size());
+        icon_rect = QRectF(rect.center().x() - size.width() / 2.0,
+                           rect.center().y() - size.height() / 2.0,
+                           size.width(), size.height());
+    }
+
+    updateTextureNode(&slot.icon, icon.texture, icon_rect, icon.source);
+}
+
+void KeyboardNode::updateBatches()
+{
+    QHash<QSGTexture *, BackgroundBatch *>::iterator it(m_batches.begin());
+
+    while (it != m_batches.end()) {
+        BackgroundBatch *const batch(it.value());
+
+        if (batch->keys.isEmpty()) {
+            m_backgrounds->removeChildNode(batch);
+            delete batch;
+            it = m_batches.erase(it);
+            continue;
+        }
+
+        if (batch->rebuild) {
+            batch->geometry()->allocate(batch->keys.count() * VerticesPerKey);
+
+            for (int position = 0; position < batch->keys.count(); ++position) {
+                writeVertices(batch, position);
+            }
+
+            batch->markDirty(QSGNode::DirtyGeometry);
+            batch->rebuild = false;
+        }
+
+        ++it;
+    }
+}
+
+//! Drops the textures of labels no key shows, once there are more than
+//! MaxUnusedLabels of them. Otherwise, every label text, font and size ever
+//! shown (e.g. through extended keys or word candidates in other layouts)
+//! would keep its texture.
+void KeyboardNode::pruneLabels()
+{
+    if (m_labels.count() <= m_slots.count() + MaxUnusedLabels) {
+        return;
+    }
+
+    QSet<QSGTexture *> used;
+
+    for (int index = 0; index < m_slots.count(); ++index) {
+        if (m_slots.at(index).label) {
+            used.insert(m_slots.at(index).label->texture());
+        }
+    }
+
+    QHash<QString, QSGTexture *>::iterator it(m_labels.begin());
+
+    while (it != m_labels.end()) {
+        if (used.contains(it.value())) {
+            ++it;
+        } else {
+            delete it.value();
+            it = m_labels.erase(it);
+        }
+    }
+}
+
+ImageRef KeyboardNode::image(const QByteArray &base_name)
+{
+    if (base_name.isEmpty() || m_image_directory.isEmpty()) {
+        return ImageRef();
+    }
+
+    const QHash<QByteArray, ImageRef>::const_iterator it(m_images.constFind(base_name));
+
+    if (it != m_images.constEnd()) {
+        return it.value();
+    }
+
+    ImageRef ref;
+    QSGTexture *const atlas(atlasTexture());
+
+    if (atlas && m_atlas.contains(base_name)) {
+        ref.texture = atlas;
+        ref.source = m_atlas.rect(base_name);
+    } else {
+        const QString path(imagePath(m_image_directory, base_name));
+        const QImage image(path);
+
+        if (image.isNull()) {
+            qWarning() << __PRETTY_FUNCTION__
+                       << "Cannot load image:" << path;
+        } else {
+            ref.texture = m_window->createTextureFromImage(image);
+            ref.source = QRect(QPoint(), image.size());
+            m_image_textures.append(ref.texture);
+        }
+    }
+
+    // Also remember missing images, to not try loading them for every key:
+    m_images.insert(base_name, ref);
+    return ref;
+}
+
+QSGTexture *KeyboardNode::atlasTexture()
+{
+    if (m_atlas_loaded) {
+        return m_atlas_texture;
+    }
+
+    m_atlas_loaded = true;
+
+    // Loaded or packed once for all renderers, on the cache's worker thread:
+    const QImage image(m_image_cache ? m_image_cache->atlasImage(m_image_directory, &m_atlas)
+                                     : QImage());
+
+    if (not image.isNull()) {
+        m_atlas_texture = m_window->createTextureFromImage(image);
+        m_image_textures.append(m_atlas_texture);
+    }
+
+    return m_atlas_texture;
+}
+
+//! Renders a key label, the way the Text element in Keyboard.qml would.
+QSGTexture *KeyboardNode::labelTexture(const QString &text,
+                                       const Font &font,
+                                       const QSize &size)
+{
+    if (size.isEmpty()) {
+        return 0;
+    }
+
+    const QString id(QString("%1|%2|%3|%4|%5x%6")
+                     .arg(text, QString(font.name()), QString::number(font.size()), QString(font.color()))
+                     .arg(size.width())
+                     .arg(size.height()));
+    const QHash<QString, QSGTexture *>::const_iterator it(m_labels.constFind(id));
+
+    if (it != m_labels.constEnd()) {
+        return it.value();
+    }
+
+    QImage image(size, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::transparent);
+
+    // Point sizes need to match the screen, not the default image resolution:
+    if (m_window->screen()) {
+        const int dots_per_meter(qRound(m_window->screen()->logicalDotsPerInch() / 0.0254));
+        image.setDotsPerMeterX(dots_per_meter);
+        image.setDotsPerMeterY(dots_per_meter);
+    }
+
+    QFont label_font(QString(font.name()));
+    label_font.setPointSize(qMax<int>(1, font.size()));
+
+    QPainter painter(&image);
+    painter.setFont(label_font);
+    painter.setPen(QColor(QString(font.color())));
+    painter.drawText(QRect(QPoint(), size), Qt::AlignCenter, text);
+    painter.end();
+
+    QSGTexture *const texture(m_window->createTextureFromImage(image));
+    m_labels.insert(id, texture);
+
+    return texture;
+}
+
+void KeyboardNode::releaseKey(int index)
+{
+    KeySlot &slot(m_slots[index]);
+
+    if (BackgroundBatch *batch = m_batches.value(slot.background_image.texture)) {
+        batch->keys.removeOne(index);
+        batch->rebuild = true;
+    }
+
+    if (slot.patches) {
+        m_backgrounds->removeChildNode(slot.patches);
+        delete slot.patches;
+    }
+
+    updateTextureNode(&slot.label, 0, QRectF());
+    updateTextureNode(&slot.icon, 0, QRectF());
+
+    slot = KeySlot();
+}
+
+void KeyboardNode::writeVertices(BackgroundBatch *batch,
+                                 int position)
+{
+    const KeySlot &slot(m_slots.at(batch->keys.at(position)));
+    QSGTexture *const texture(batch->texture());
+    const QSize &size(texture->textureSize());
+    const QRectF &sub_rect(texture->normalizedTextureSubRect());
+    const QRect &source(slot.background_image.source);
+
+    qreal x[4];
+    qreal y[4];
+    qreal u[4];
+    qreal v[4];
+
+    sliceEdges(slot.rect.left(), slot.rect.right(), slot.borders.x(), slot.borders.width(), x);
+    sliceEdges(slot.rect.top(), slot.rect.bottom(), slot.borders.y(), slot.borders.height(), y);
+    sliceEdges(source.x(), source.x() + source.width(), slot.borders.x(), slot.borders.width(), u);
+    sliceEdges(source.y(), source.y() + source.height(), slot.borders.y(), slot.borders.height(), v);
+
+    for (int index = 0; index < 4; ++index) {
+        u[index] = sub_rect.x() + sub_rect.width() * u[index] / qMax(1, size.width());
+        v[index] = sub_rect.y() + sub_rect.height() * v[index] / qMax(1, size.height());
+    }
+
+    QSGGeometry::TexturedPoint2D *vertex(batch->geometry()->vertexDataAsTexturedPoint2D()
+                                         + position * VerticesPerKey);
+
+    for (int row = 0; row < 3; ++row) {
+        for (int column = 0; column < 3; ++column) {
+            const int r(row + 1);
+            const int c(column + 1);
+
+            vertex[0].set(x[column], y[row], u[column], v[row]);
+            vertex[1].set(x[c], y[row], u[c], v[row]);
+            vertex[2].set(x[column], y[r], u[column], v[r]);
+            vertex[3].set(x[c], y[row], u[c], v[row]);
+            vertex[4].set(x[c], y[r], u[c], v[r]);
+            vertex[5].set(x[column], y[r], u[column], v[r]);
+            vertex += 6;
+        }
+    }
+}
+
+//! Renders a key background through nine texture nodes, for scene graph
+//! backends without custom geometry support.
+void KeyboardNode::updatePatches(KeySlot *slot)
+{
+    QSGTexture *const texture(slot->background_image.texture);
+
+    if (not texture) {
+        if (slot->patches) {
+            m_backgrounds->removeChildNode(slot->patches);
+            delete slot->patches;
+            slot->patches = 0;
+        }
+
+        return;
+    }
+
+    if (not slot->patches) {
+        slot->patches = new QSGNode;
+
+        for (int index = 0; index < 9; ++index) {
+            QSGSimpleTextureNode *const patch(new QSGSimpleTextureNode);
+            patch->setFiltering(QSGTexture::Linear);
+            slot->patches->appendChildNode(patch);
+        }
+
+        m_backgrounds->appendChildNode(slot->patches);
+    }
+
+    const QRect &source(slot->background_image.source);
+    qreal x[4];
+    qreal y[4];
+    qreal u[4];
+    qreal v[4];
+
+    sliceEdges(slot->rect.left(), slot->rect.right(), slot->borders.x(), slot->borders.width(), x);
+    sliceEdges(slot->rect.top(), slot->rect.bottom(), slot->borders.y(), slot->borders.height(), y);
+    sliceEdges(source.x(), source.x() + source.width(), slot->borders.x(), slot->borders.width(), u);
+    sliceEdges(source.y(), source.y() + source.height(), slot->borders.y(), slot->borders.height(), v);
+
+    QSGNode *node(slot->patches->firstChild());
+
+    for (int row = 0; row < 3; ++row) {
+        for (int column = 0; column < 3; ++column) {
+            QSGSimpleTextureNode *const patch(static_cast<QSGSimpleTextureNode *>(node));
+
+            if (patch->texture() != texture) {
+                patch->setTexture(texture);
+            }
+
+            patch->setRect(QRectF(x[column], y[row],
+                                  x[column + 1] - x[column], y[row + 1] - y[row]));
+            patch->setSourceRect(QRectF(u[column], v[row],
+                                        u[column + 1] - u[column], v[row + 1] - v[row]));
+            node = node->nextSibling();
+        }
+    }
+}
+
+void KeyboardNode::updateTextureNode(QSGSimpleTextureNode **node,
+                                     QSGTexture *texture,
+                                     const QRectF &rect,
+                                     const QRectF &source)
+{
+    if (not texture) {
+        if (*node) {
+            m_contents->removeChildNode(*node);
+            delete *node;
+            *node = 0;
+        }
+
+        return;
+    }
+
+    if (not *node) {
+        *node = new QSGSimpleTextureNode;
+        (*node)->setFiltering(QSGTexture::Linear);
+        m_contents->appendChildNode(*node);
+    }
+
+    if ((*node)->texture() != texture) {
+        (*node)->setTexture(texture);
+    }
+
+    if ((*node)->rect() != rect) {
+        (*node)->setRect(rect);
+    }
+
+    if ((*node)->sourceRect() != source) {
+        (*node)->setSourceRect(source);
+    }
+}
+
+} // namespace
+
+
+class KeyboardRendererPrivate
+{
+public:
+    QPointer<Model::Layout> layout;
+    QSet<int> dirty_keys;
+    bool all_keys_dirty;
+
+    explicit KeyboardRendererPrivate();
+};
+
+
+KeyboardRendererPrivate::KeyboardRendererPrivate()
+    : layout()
+    , dirty_keys()
+    , all_keys_dirty(true)
+{}
+
+
+KeyboardRenderer::KeyboardRenderer(QQuickItem *parent)
+    : QQuickItem(parent)
+    , d_ptr(new KeyboardRendererPrivate)
+{
+    setFlag(ItemHasContents, true);
+}
+
+
+KeyboardRenderer::~KeyboardRenderer()
+{}
+
+
+QObject *KeyboardRenderer::layout() const
+{
+    Q_D(const KeyboardRenderer);
+    return d->layout.data();
+}
+
+
+//! \brief Sets the Model::Layout instance whose keys are rendered.
+void KeyboardRenderer::setLayout(QObject *layout)
+{
+    Q_D(KeyboardRenderer);
+    Model::Layout *const model(qobject_cast<Model::Layout *>(layout));
+
+    if (layout && not model) {
+        qWarning() << __PRETTY_FUNCTION__
+                   << "Not a keyboard layout model:" << layout;
+    }
+
+    if (d->layout.data() == model) {
+        return;
+    }
+
+    if (d->layout) {
+        disconnect(d->layout.data(), 0, this, 0);
+    }
+
+    d->layout = model;
+
+    if (model) {
+        connect(model, SIGNAL(dataChanged(QModelIndex,QModelIndex)),
+                this,  SLOT(onKeysChanged(QModelIndex,QModelIndex)));
+        connect(model, SIGNAL(rowsInserted(QModelIndex,int,int)),
+                this,  SLOT(onAllKeysChanged()));
+        connect(model, SIGNAL(rowsRemoved(QModelIndex,int,int)),
+                this,  SLOT(onAllKeysChanged()));
+        connect(model, SIGNAL(modelReset()),
+                this,  SLOT(onAllKeysChanged()));
+        connect(model, SIGNAL(imageAtlasChanged()),
+                this,  SLOT(onAllKeysChanged()));
+    }
+
+    onAllKeysChanged();
+    Q_EMIT layoutChanged(model);
+}
+
+
+QSGNode *KeyboardRenderer::updatePaintNode(QSGNode *node,
+                                           UpdatePaintNodeData *data)
+{
+    Q_UNUSED(data)
+    Q_D(KeyboardRenderer);
+
+    // The GUI thread is blocked while this runs, so the model can be read
+    // directly.
+    KeyboardNode *keyboard(static_cast<KeyboardNode *>(node));
+
+    if (not d->layout) {
+        delete keyboard;
+        return 0;
+    }
+
+    if (not keyboard) {
+        keyboard = new KeyboardNode(window(), imageCache(this, d->layout->imageProvider()));
+        d->all_keys_dirty = true;
+    }
+
+    const Model::Layout *const layout(d->layout.data());
+    const int count(layout->rowCount());
+    const qreal scale(layout->scaleRatio());
+
+    if (keyboard->setImages(layout->imageDirectory(), layout->imageAtlas())) {
+        d->all_keys_dirty = true;
+    }
+
+    keyboard->setKeyCount(count);
+
+    if (d->all_keys_dirty) {
+        for (int index = 0; index < count; ++index) {
+            keyboard->updateKey(index, layout->key(index), scale);
+        }
+    } else {
+        Q_FOREACH (int index, d->dirty_keys) {
+            if (index < count) {
+                keyboard->updateKey(index, layout->key(index), scale);
+            }
+        }
+    }
+
+    keyboard->updateBatches();
+    keyboard->pruneLabels();
+
+    d->dirty_keys.clear();
+    d->all_keys_dirty = false;
+
+    return keyboard;
+}
+
+
+void KeyboardRenderer::onKeysChanged(const QModelIndex &top_left,
+                                     const QModelIndex &bottom_right)
+{
+    Q_D(KeyboardRenderer);
+
+    for (int row = top_left.row(); row <= bottom_right.row(); ++row) {
+        d->dirty_keys.insert(row);
+    }
+
+    update();
+}
+
+
+void KeyboardRenderer::onAllKeysChanged()
+{
+    Q_D(KeyboardRenderer);
+
+    d->dirty_keys.clear();
+    d->all_keys_dirty = true;
+    update();
+}
+
+} // namespace MaliitKeyboard
@@ -0,0 +1,80 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012-2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef MALIIT_KEYBOARD_KEYBOARDRENDERER_H
+#define MALIIT_KEYBOARD_KEYBOARDRENDERER_H
+
+#include <QtQuick>
+
+namespace MaliitKeyboard {
+
+class KeyboardRendererPrivate;
+
+//! \brief Renders the keys of a Model::Layout in a single scene graph item.
+//!
+//! Replaces the per-key BorderImage, Text and Image delegates of Keyboard.qml.
+//! Keys are drawn from the style's image atlas, so that all key backgrounds
+//! are batched into one geometry node. Only keys reported as changed by the
+//! model are updated.
+class KeyboardRenderer
+    : public QQuickItem
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(KeyboardRenderer)
+    Q_DECLARE_PRIVATE(KeyboardRenderer)
+
+    Q_PROPERTY(QObject *layout READ layout
+                               WRITE setLayout
+                               NOTIFY layoutChanged)
+
+public:
+    explicit KeyboardRenderer(QQuickItem *parent = 0);
+    virtual ~KeyboardRenderer();
+
+    QObject *layout() const;
+    void setLayout(QObject *layout);
+    Q_SIGNAL void layoutChanged(QObject *changed);
+
+protected:
+    virtual QSGNode *updatePaintNode(QSGNode *node,
+                                     UpdatePaintNodeData *data);
+
+private:
+    Q_SLOT void onKeysChanged(const QModelIndex &top_left,
+                              const QModelIndex &bottom_right);
+    Q_SLOT void onAllKeysChanged();
+
+    const QScopedPointer<KeyboardRendererPrivate> d_ptr;
+};
+
+} // namespace MaliitKeyboard
+
+#endif // MALIIT_KEYBOARD_KEYBOARDRENDERER_H
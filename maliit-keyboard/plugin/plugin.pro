@@ -25,6 +25,10 @@ HEADERS += \
     editor.h \
     updatenotifier.h \
     maliitcontext.h \
+    keyboardrenderer.h \
+    keyboardinputarea.h \
+    startuptimeline.h \
+    styleimageprovider.h \
 
 SOURCES += \
     plugin.cpp \
@@ -32,6 +36,10 @@ SOURCES += \
     editor.cpp \
     updatenotifier.cpp \
     maliitcontext.cpp \
+    keyboardrenderer.cpp \
+    keyboardinputarea.cpp \
+    startuptimeline.cpp \
+    styleimageprovider.cpp \
 
 target.path += $${MALIIT_PLUGINS_DIR}
 INSTALLS += target
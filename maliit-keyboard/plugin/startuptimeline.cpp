@@ -0,0 +1,124 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012-2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "startuptimeline.h"
+
+namespace MaliitKeyboard {
+
+//! \class StartupTimeline
+//! Measures the stages of plugin startup. Each mark prints how long the
+//! stage took since the previous mark, and the time since startup. Stages
+//! that finish in the background, such as loading the word engine, are
+//! reported with markDone() once they finished. Stays silent unless the
+//! MALIIT_KEYBOARD_STARTUP_TIMELINE environment variable is set.
+
+class StartupTimelinePrivate
+{
+public:
+    const bool enabled;
+    QElapsedTimer timer;
+    qint64 last_mark;
+
+    explicit StartupTimelinePrivate();
+};
+
+StartupTimelinePrivate::StartupTimelinePrivate()
+    : enabled(StartupTimeline::enabledFromEnvironment())
+    , timer()
+    , last_mark(0)
+{}
+
+
+//! \brief Constructor. Starts the timeline.
+StartupTimeline::StartupTimeline()
+    : d_ptr(new StartupTimelinePrivate)
+{
+    Q_D(StartupTimeline);
+
+    if (d->enabled) {
+        d->timer.start();
+    }
+}
+
+
+StartupTimeline::~StartupTimeline()
+{}
+
+
+bool StartupTimeline::isEnabled() const
+{
+    Q_D(const StartupTimeline);
+    return d->enabled;
+}
+
+
+//! \brief Ends a stage that ran on the critical path.
+//! \param stage Name of the stage.
+void StartupTimeline::mark(const char *stage)
+{
+    Q_D(StartupTimeline);
+
+    if (not d->enabled) {
+        return;
+    }
+
+    const qint64 now(d->timer.elapsed());
+
+    qDebug() << "Startup:" << stage << "took" << (now - d->last_mark) << "ms,"
+             << "at" << now << "ms";
+    d->last_mark = now;
+}
+
+
+//! \brief Reports a stage that ran in the background, without ending the
+//!        current critical path stage.
+//! \param stage Name of the stage.
+void StartupTimeline::markDone(const char *stage)
+{
+    Q_D(StartupTimeline);
+
+    if (not d->enabled) {
+        return;
+    }
+
+    qDebug() << "Startup:" << stage << "ready at" << d->timer.elapsed() << "ms";
+}
+
+
+//! \brief Returns whether the timeline was requested through the
+//!        MALIIT_KEYBOARD_STARTUP_TIMELINE environment variable.
+bool StartupTimeline::enabledFromEnvironment()
+{
+    static const QByteArray value(qgetenv("MALIIT_KEYBOARD_STARTUP_TIMELINE"));
+    return (not value.isEmpty() && value != "0");
+}
+
+} // namespace MaliitKeyboard
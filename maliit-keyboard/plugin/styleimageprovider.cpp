@@ -0,0 +1,341 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012-2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "styleimageprovider.h"
+#include "view/imageatlascomposer.h"
+
+namespace MaliitKeyboard {
+
+//! \class StyleImageCache
+//! Keeps the decoded images of the active style profile, shared by all
+//! surfaces. preload() decodes all images of a profile on a worker thread,
+//! so that key delegates find them ready, even when they are recreated.
+//! Images that are not preloaded yet are decoded on first request.
+//!
+//! If constructed with_atlas, preload() also prepares the image atlas of
+//! the profile on the worker thread, before any single image: the atlas
+//! shipped with the style, or one packed from the images if the style has
+//! none. All KeyboardRenderer instances then share that one atlas image.
+
+class StyleImageCachePrivate
+{
+public:
+    QThreadPool pool;
+    QMutex mutex;
+    QWaitCondition atlas_prepared;
+    const bool with_atlas;
+    QString directory; //!< Images directory of the active profile.
+    QHash<QString, QImage> images; //!< Decoded images, by absolute file name.
+    bool atlas_pending; //!< Whether the worker still prepares the atlas.
+    QImage atlas_image;
+    ImageAtlas atlas; //!< Coordinate table of atlas_image.
+
+    explicit StyleImageCachePrivate(bool with_atlas);
+    void insert(const QString &file_name,
+                const QImage &image);
+};
+
+StyleImageCachePrivate::StyleImageCachePrivate(bool with_atlas)
+    : pool()
+    , mutex()
+    , atlas_prepared()
+    , with_atlas(with_atlas)
+    , directory()
+    , images()
+    , atlas_pending(false)
+    , atlas_image()
+    , atlas()
+{
+    pool.setMaxThreadCount(1);
+}
+
+
+//! Caches the image, unless it belongs to a profile that is not active
+//! anymore. Needs the mutex to be locked.
+void StyleImageCachePrivate::insert(const QString &file_name,
+                                    const QImage &image)
+{
+    if (not image.isNull()
+        && QFileInfo(file_name).absolutePath() == directory) {
+        images.insert(file_name, image);
+    }
+}
+
+
+class StyleImageCacheJob
+    : public QRunnable
+{
+public:
+    StyleImageCacheJob(StyleImageCache *cache,
+                       const QString &directory,
+                       const ImageAtlas &atlas)
+        : m_cache(cache)
+        , m_directory(directory)
+        , m_atlas(atlas)
+    {}
+
+    virtual void run()
+    {
+        StyleImageCachePrivate *const d(m_cache->d_func());
+        const QDir dir(m_directory);
+
+        if (d->with_atlas) {
+            prepareAtlas(d);
+        }
+
+        Q_FOREACH (const QFileInfo &info, dir.entryInfoList(QStringList() << "*.png", QDir::Files)) {
+            // A precompiled atlas is not requested by key delegates:
+            if (info.fileName() == ImageAtlasImageFileName) {
+                continue;
+            }
+
+            const QString file_name(info.absoluteFilePath());
+
+            {
+                QMutexLocker locker(&d->mutex);
+
+                // Stop early if another profile got activated meanwhile:
+                if (d->directory != m_directory) {
+                    return;
+                }
+
+                if (d->images.contains(file_name)) {
+                    continue;
+                }
+            }
+
+            const QImage image(file_name);
+
+            if (image.isNull()) {
+                qWarning() << __PRETTY_FUNCTION__
+                           << "Cannot decode image:" << file_name;
+                continue;
+            }
+
+            QMutexLocker locker(&d->mutex);
+            d->insert(file_name, image);
+        }
+    }
+
+private:
+    StyleImageCache *const m_cache;
+    const QString m_directory;
+    const ImageAtlas m_atlas; //!< As shipped with the style, can be invalid.
+
+    void prepareAtlas(StyleImageCachePrivate *d)
+    {
+        ImageAtlas atlas(m_atlas);
+        QImage image;
+
+        if (atlas.isValid()) {
+            image = QImage(atlas.fileName());
+
+            if (image.isNull()) {
+                qWarning() << __PRETTY_FUNCTION__
+                           << "Cannot load image atlas:" << atlas.fileName();
+            }
+        }
+
+        // The style ships no (usable) atlas, pack one now:
+        if (image.isNull()) {
+            image = composeImageAtlas(m_directory, &atlas);
+        }
+
+        QMutexLocker locker(&d->mutex);
+
+        // Another profile got activated meanwhile, its own job follows:
+        if (d->directory != m_directory) {
+            return;
+        }
+
+        d->atlas_image = image;
+        d->atlas = (image.isNull() ? ImageAtlas() : atlas);
+        d->atlas_pending = false;
+        d->atlas_prepared.wakeAll();
+    }
+};
+
+
+//! \param with_atlas Whether preload() also prepares the image atlas, see
+//!                   atlasImage().
+StyleImageCache::StyleImageCache(bool with_atlas)
+    : d_ptr(new StyleImageCachePrivate(with_atlas))
+{}
+
+
+StyleImageCache::~StyleImageCache()
+{
+    Q_D(StyleImageCache);
+    d->pool.clear();
+
+    {
+        QMutexLocker locker(&d->mutex);
+        d->atlas_pending = false;
+        d->atlas_prepared.wakeAll();
+    }
+
+    d->pool.waitForDone();
+}
+
+
+//! \brief Drops the images of the previous profile and starts decoding all
+//!        images in directory, in the background.
+//! \param directory The images directory of the new style profile.
+//! \param atlas The image atlas shipped with the profile, if any.
+void StyleImageCache::preload(const QString &directory,
+                              const ImageAtlas &atlas)
+{
+    Q_D(StyleImageCache);
+    const QString absolute_directory(QDir(directory).absolutePath());
+
+    {
+        QMutexLocker locker(&d->mutex);
+
+        if (d->directory == absolute_directory) {
+            return;
+        }
+
+        d->directory = absolute_directory;
+        d->images.clear();
+        d->atlas_pending = d->with_atlas;
+        d->atlas_image = QImage();
+        d->atlas = ImageAtlas();
+    }
+
+    d->pool.start(new StyleImageCacheJob(this, absolute_directory, atlas));
+}
+
+
+//! \brief Returns the decoded image, decoding it now if it was not
+//!        preloaded yet. Can be called from any thread.
+//! \param file_name Absolute file name of the image.
+QImage StyleImageCache::image(const QString &file_name)
+{
+    Q_D(StyleImageCache);
+
+    {
+        QMutexLocker locker(&d->mutex);
+        const QHash<QString, QImage>::const_iterator it(d->images.constFind(file_name));
+
+        if (it != d->images.constEnd()) {
+            return it.value();
+        }
+    }
+
+    const QImage image(file_name);
+
+    QMutexLocker locker(&d->mutex);
+    d->insert(file_name, image);
+
+    return image;
+}
+
+
+//! \brief Returns the atlas image of the active profile, waiting for the
+//!        worker thread if it is still preparing it. Can be called from any
+//!        thread.
+//! \param directory The images directory the atlas is wanted for.
+//! \param atlas Receives the coordinate table of the returned image.
+//! \returns A null image if directory is not the active profile, or if
+//!          the cache was not constructed with_atlas.
+QImage StyleImageCache::atlasImage(const QString &directory,
+                                   ImageAtlas *atlas)
+{
+    Q_D(StyleImageCache);
+    const QString absolute_directory(QDir(directory).absolutePath());
+    QMutexLocker locker(&d->mutex);
+
+    while (d->atlas_pending && d->directory == absolute_directory) {
+        d->atlas_prepared.wait(&d->mutex);
+    }
+
+    if (d->directory != absolute_directory) {
+        if (atlas) {
+            *atlas = ImageAtlas();
+        }
+
+        return QImage();
+    }
+
+    if (atlas) {
+        *atlas = d->atlas;
+    }
+
+    return d->atlas_image;
+}
+
+
+//! \class StyleImageProvider
+//! Hands out images from a StyleImageCache. Every QML engine owns its own
+//! provider, but all providers share one cache. Image ids are absolute
+//! file names, without the leading slash, see Model::Layout::setImageProvider().
+
+StyleImageProvider::StyleImageProvider(const SharedImageCache &cache)
+    : QQuickImageProvider(QQuickImageProvider::Image)
+    , m_cache(cache)
+{}
+
+
+StyleImageProvider::~StyleImageProvider()
+{}
+
+
+QImage StyleImageProvider::requestImage(const QString &id,
+                                        QSize *size,
+                                        const QSize &requested_size)
+{
+    const QImage image(m_cache->image(QDir::root().absoluteFilePath(id)));
+
+    if (image.isNull()) {
+        qWarning() << __PRETTY_FUNCTION__
+                   << "Cannot load image:" << id;
+    }
+
+    if (size) {
+        *size = image.size();
+    }
+
+    if (requested_size.width() > 0 && requested_size.height() > 0
+        && requested_size != image.size() && not image.isNull()) {
+        return image.scaled(requested_size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+    }
+
+    return image;
+}
+
+
+//! \brief Returns the cache shared by all providers, see KeyboardRenderer.
+SharedImageCache StyleImageProvider::cache() const
+{
+    return m_cache;
+}
+
+} // namespace MaliitKeyboard
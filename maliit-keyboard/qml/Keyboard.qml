@@ -30,12 +30,19 @@
  */
 
 import QtQuick 2.0
+import MaliitKeyboard 1.0
 
 Item {
-    property alias layout: main.model
+    id: keyboard
+
+    property variant layout
     property variant event_handler
     property bool area_enabled // MouseArea has no id property so we cannot alias its enabled property.
     property alias title: keyboard_title.text
+    // Draw keys through a single KeyboardRenderer instead of per-key delegates:
+    property bool native_rendering: maliit_native_rendering
+    // Dispatch input through a single KeyboardInputArea instead of per-key MouseAreas:
+    property bool native_input: maliit_native_input
 
     width: layout.width
     height: layout.height
@@ -60,9 +67,16 @@ Item {
         border.bottom: layout.background_borders.height
     }
 
+    KeyboardRenderer {
+        anchors.fill: parent
+        layout: native_rendering ? keyboard.layout : null
+        visible: native_rendering
+    }
+
     Repeater {
         id: main
-        model: layout
+        // Delegates are not needed at all if neither drawing nor input use them:
+        model: (native_rendering && native_input) ? 0 : layout
         anchors.fill: parent
 
         Item {
@@ -71,86 +85,105 @@ Item {
             width: key_reactive_area.width
             height: key_reactive_area.height
 
-            BorderImage {
+            Loader {
                 x: key_rectangle.x
                 y: key_rectangle.y
                 width: key_rectangle.width
                 height: key_rectangle.height
+                active: !native_rendering
+
+                sourceComponent: BorderImage {
+                    border.left: key_background_borders.x
+                    border.top: key_background_borders.y
+                    border.right: key_background_borders.width
+                    border.bottom: key_background_borders.height
+
+                    source: key_background
+
+                    Text {
+                        anchors.fill: parent
+                        text: key_text
+                        font.family: key_font
+                        font.pointSize: key_font_size
+                        color: key_font_color
+                        horizontalAlignment: Text.AlignHCenter
+                        verticalAlignment: Text.AlignVCenter
+                        visible: (key_text.length != 0)
+                    }
 
-                border.left: key_background_borders.x
-                border.top: key_background_borders.y
-                border.right: key_background_borders.width
-                border.bottom: key_background_borders.height
-
-                source: key_background
-
-                Text {
-                    anchors.fill: parent
-                    text: key_text
-                    font.family: key_font
-                    font.pointSize: key_font_size
-                    color: key_font_color
-                    horizontalAlignment: Text.AlignHCenter
-                    verticalAlignment: Text.AlignVCenter
-                    visible: (key_text.length != 0)
-                }
-
-                Image {
-                    anchors.centerIn: parent
-                    source: key_icon
-                    visible: (key_icon.length != 0)
+                    Image {
+                        anchors.centerIn: parent
+                        source: key_icon
+                        visible: (key_icon.length != 0)
+                    }
                 }
             }
 
-            MouseArea {
-                property real start_x
-                property real start_y
+            Loader {
+                anchors.fill: parent
+                active: !native_input
 
-                Timer {
-                    id: gesture_timeout
-                    interval: 500
-                }
+                sourceComponent: MouseArea {
+                    property real start_x
+                    property real start_y
 
-                enabled: area_enabled
-                anchors.fill: parent
-                hoverEnabled: true
+                    Timer {
+                        id: gesture_timeout
+                        interval: 500
+                    }
 
-                onEntered: event_handler.onEntered(index)
-                onExited: event_handler.onExited(index)
+                    enabled: area_enabled
+                    anchors.fill: parent
+                    hoverEnabled: true
 
-                onPressed: {
-                    start_x = mouse.x
-                    start_y = mouse.y
-                    gesture_timeout.start()
+                    onEntered: event_handler.onEntered(index)
+                    onExited: event_handler.onExited(index)
 
-                    event_handler.onPressed(index)
-                }
+                    onPressed: {
+                        start_x = mouse.x
+                        start_y = mouse.y
+                        gesture_timeout.start()
 
-                onReleased: event_handler.onReleased(index)
-                onPressAndHold: event_handler.onPressAndHold(index)
-
-                // TODO: Move logic into EventHandler because gestures should depend on style?
-                // Hide keyboard on flick-down gesture (but only if there is an event_handler)
-                // or switch to left/right layout:
-                onPositionChanged: {
-                    if (event_handler
-                        && gesture_timeout.running
-                        && (mouse.y - start_y > (layout.height * 0.3))) {
-                        maliit.hide()
-                    } else if (event_handler
-                               && gesture_timeout.running
-                               && (mouse.x - start_x > (layout.width * 0.2))) {
-                        maliit.selectLeftLayout()
-                    } else if (event_handler
-                               && gesture_timeout.running
-                               && (start_x - mouse.x > (layout.width * 0.2))) {
-                        maliit.selectRightLayout()
+                        event_handler.onPressed(index)
+                    }
+
+                    onReleased: event_handler.onReleased(index)
+                    onPressAndHold: event_handler.onPressAndHold(index)
+
+                    // TODO: Move logic into EventHandler because gestures should depend on style?
+                    // Hide keyboard on flick-down gesture (but only if there is an event_handler)
+                    // or switch to left/right layout:
+                    onPositionChanged: {
+                        if (event_handler
+                            && gesture_timeout.running
+                            && (mouse.y - start_y > (layout.height * 0.3))) {
+                            maliit.hide()
+                        } else if (event_handler
+                                   && gesture_timeout.running
+                                   && (mouse.x - start_x > (layout.width * 0.2))) {
+                            maliit.selectLeftLayout()
+                        } else if (event_handler
+                                   && gesture_timeout.running
+                                   && (start_x - mouse.x > (layout.width * 0.2))) {
+                            maliit.selectRightLayout()
+                        }
                     }
                 }
             }
         }
     }
 
+    KeyboardInputArea {
+        anchors.fill: parent
+        enabled: native_input && area_enabled
+        layout: native_input ? keyboard.layout : null
+        event_handler: (native_input && keyboard.event_handler) ? keyboard.event_handler : null
+
+        onFlickedDown: maliit.hide()
+        onFlickedRight: maliit.selectLeftLayout()
+        onFlickedLeft: maliit.selectRightLayout()
+    }
+
     // Keyboard title rendering
     // TODO: Make separate component?
     Item {
@@ -0,0 +1,81 @@
+/*
+ * This file is part of Maliit plugins
+ *
+ * Copyright (C) 2012-2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+import QtQuick 2.0
+
+// Keyboard, extended keys and magnifier in one window. The window reaches
+// above the keyboard, to leave room for the overlays of top row keys.
+Item {
+    width: main_keyboard.width
+    height: main_keyboard.height + maliit_overlay_headroom
+
+    Keyboard {
+        id: main_keyboard
+
+        y: maliit_overlay_headroom
+
+        layout: maliit_layout
+        event_handler: maliit_event_handler
+        area_enabled: !maliit_extended_layout.visible
+        title: maliit_layout.title
+    }
+
+    Keyboard {
+        x: maliit_extended_layout.origin.x
+        y: maliit_overlay_headroom + maliit_extended_layout.origin.y
+        z: 1
+
+        layout: maliit_extended_layout
+        event_handler: maliit_extended_event_handler
+        area_enabled: maliit_extended_layout.visible
+
+        opacity: visible ? 1.0 : 0.0
+
+        // Only animates appearance because we reset extended keys model
+        // immediately after selecting a key.
+        Behavior on opacity {
+            PropertyAnimation {
+                duration: 300
+                easing.type: Easing.InOutQuad
+            }
+        }
+    }
+
+    Keyboard {
+        x: maliit_magnifier_layout.origin.x * maliit_layout.scale_ratio
+        y: maliit_overlay_headroom + maliit_magnifier_layout.origin.y * maliit_layout.scale_ratio
+        z: 2
+
+        layout: maliit_magnifier_layout
+        area_enabled: false
+        visible: !maliit_extended_layout.visible
+    }
+}
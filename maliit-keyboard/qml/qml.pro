@@ -11,4 +11,5 @@ OTHER_FILES += \
     maliit-keyboard.qml \
     maliit-keyboard-extended.qml \
     maliit-magnifier.qml \
+    maliit-keyboard-single.qml \
     Keyboard.qml \
@@ -35,10 +35,18 @@
 #include "models/key.h"
 #include "models/keydescription.h"
 #include "models/keyboard.h"
+#include "models/keystyletable.h"
 #include "models/styleattributes.h"
 #include "logic/keyboardloader.h"
+#include "logic/keyboardbuilder.h"
+#include "logic/layoutcache.h"
+#include "logic/languageindex.h"
+#include "logic/keyboardvariantcache.h"
+#include "logic/layoutwarmup.h"
 #include "logic/keyareaconverter.h"
 #include "logic/style.h"
+#include "parser/layoutparser.h"
+#include "parser/layoutblob.h"
 #include "logic/layouthelper.h"
 
 #include <QtCore>
@@ -206,6 +214,51 @@ Key getKey(const QString &text,
     return key;
 }
 
+// Dumps labels, actions and modifiers of all rows, recursing into extended
+// keys, so that two tag trees can be compared.
+QString dumpRows(const TagRowPtrs &rows)
+{
+    QString dump;
+
+    Q_FOREACH (const TagRowPtr &row, rows) {
+        Q_FOREACH (const TagRowElementPtr &element, row->elements()) {
+            if (element->element_type() == TagRowElement::Spacer) {
+                dump += "_ ";
+                continue;
+            }
+
+            const TagKeyPtr key(element.staticCast<TagKey>());
+            const TagBindingPtr binding(key->binding());
+
+            dump += QString("%1:%2:%3:%4").arg(binding->label()).arg(binding->action())
+                                          .arg(binding->accented_labels()).arg(key->width());
+            Q_FOREACH (const TagModifiersPtr &modifiers, binding->modifiers()) {
+                dump += "/" + modifiers->binding()->label();
+            }
+            if (key->extended()) {
+                dump += "[" + dumpRows(key->extended()->rows()) + "]";
+            }
+            dump += " ";
+        }
+        dump += "\n";
+    }
+
+    return dump;
+}
+
+QString dumpKeyboard(const TagKeyboardPtr &keyboard)
+{
+    QString dump(keyboard->title() + " " + keyboard->language() + "\n");
+
+    Q_FOREACH (const TagLayoutPtr &layout, keyboard->layouts()) {
+        Q_FOREACH (const TagSectionPtr &section, layout->sections()) {
+            dump += section->id() + " " + section->style() + "\n" + dumpRows(section->rows());
+        }
+    }
+
+    return dump;
+}
+
 } // unnamed namespace
 
 class TestLanguageLayoutLoading
@@ -535,6 +588,11 @@ private:
             << getKey("", Key::ActionSpace)
             << "";
 
+        QTest::newRow("Extended keyboard lookup distinguishes actions")
+            << "extended_test"
+            << getKey("close")
+            << "";
+
         QTest::newRow("No non-action-insert prepending")
             << "extended_test"
             << getKey("close", Key::ActionClose)
@@ -552,6 +610,425 @@ private:
         COMPARE_KEYBOARDS(loader->extendedKeyboard(pressed_key), stringToKeyboard(expected_keyboard));
     }
 
+    Q_SLOT void testLayoutCache()
+    {
+        LayoutCache *const cache(KeyboardLoader::layoutCache());
+        cache->invalidateAll();
+        cache->resetStatistics();
+
+        SharedKeyboardLoader loader(getLoader("general_test1"));
+        Key dead_key;
+        dead_key.rLabel().setText(";");
+
+        // Building plain keyboards does not need a parse tree:
+        COMPARE_KEYBOARDS(loader->keyboard(), stringToKeyboard("|q|w|\n p a "));
+        QCOMPARE(cache->misses(), 0);
+
+        // First lookup parses the file, all following lookups of the same
+        // layout are answered from the cache:
+        const SharedParsedLayout layout(cache->layout("general_test1"));
+        QVERIFY(layout);
+        QCOMPARE(cache->misses(), 1);
+        QCOMPARE(cache->hits(), 0);
+
+        COMPARE_KEYBOARDS(loader->extendedKeyboard(loader->keyboard().keys.first()),
+                          stringToKeyboard("|y|u|\n|i|o|"));
+        QCOMPARE(cache->layout("general_test1"), layout);
+        QCOMPARE(cache->misses(), 1);
+        QCOMPARE(cache->hits(), 2);
+
+        // Keyboards are built from cached layouts without a lookup:
+        KeyboardLoader::variantCache()->invalidateAll();
+        COMPARE_KEYBOARDS(loader->deadKeyboard(dead_key), stringToKeyboard("|q|r|\n p a "));
+        QCOMPARE(cache->hits(), 2);
+
+        cache->invalidate("general_test1");
+        QVERIFY(cache->layout("general_test1"));
+        QCOMPARE(cache->misses(), 2);
+
+        // Cache is bounded:
+        cache->setCapacity(1);
+        QVERIFY(cache->layout("style_test1"));
+        QCOMPARE(cache->count(), 1);
+        QVERIFY(cache->layout("general_test1"));
+        QCOMPARE(cache->count(), 1);
+        QCOMPARE(cache->misses(), 4);
+
+        cache->setCapacity(LayoutCache::DefaultCapacity);
+    }
+
+    Q_SLOT void testVariantCache()
+    {
+        KeyboardVariantCache *const cache(KeyboardLoader::variantCache());
+        cache->invalidateAll();
+        cache->resetStatistics();
+
+        SharedKeyboardLoader loader(getLoader("general_test1"));
+        Key dead_key;
+        dead_key.rLabel().setText(";");
+
+        COMPARE_KEYBOARDS(loader->shiftedKeyboard(), stringToKeyboard("|Q|W|\n p a "));
+        COMPARE_KEYBOARDS(loader->shiftedKeyboard(), stringToKeyboard("|Q|W|\n p a "));
+        QCOMPARE(cache->misses(), 1);
+        QCOMPARE(cache->hits(), 1);
+
+        COMPARE_KEYBOARDS(loader->deadKeyboard(dead_key), stringToKeyboard("|q|r|\n p a "));
+        COMPARE_KEYBOARDS(loader->deadKeyboard(dead_key), stringToKeyboard("|q|r|\n p a "));
+        QCOMPARE(cache->misses(), 2);
+        QCOMPARE(cache->hits(), 2);
+
+        // Invalidated variants are built again:
+        cache->invalidate("general_test1");
+        COMPARE_KEYBOARDS(loader->shiftedKeyboard(), stringToKeyboard("|Q|W|\n p a "));
+        QCOMPARE(cache->misses(), 3);
+
+        // So are the variants of an invalidated layout:
+        KeyboardLoader::layoutCache()->invalidate("general_test1");
+        COMPARE_KEYBOARDS(loader->shiftedKeyboard(), stringToKeyboard("|Q|W|\n p a "));
+        QCOMPARE(cache->misses(), 4);
+
+        // Prebuilt variants are answered from the cache, and prebuilding
+        // does not parse the layout:
+        KeyboardLoader::layoutCache()->invalidateAll();
+        KeyboardLoader::layoutCache()->resetStatistics();
+        QCOMPARE(cache->count(), 0);
+        loader->prebuildVariants();
+        QCOMPARE(KeyboardLoader::layoutCache()->misses(), 0);
+        cache->resetStatistics();
+        loader->keyboard();
+        loader->shiftedKeyboard();
+        QCOMPARE(cache->misses(), 0);
+        QCOMPARE(cache->hits(), 2);
+    }
+
+    Q_SLOT void testKeyboardBuilder_data()
+    {
+        QTest::addColumn<QString>("keyboard_id");
+        QTest::addColumn<bool>("shifted");
+        QTest::addColumn<int>("page");
+        QTest::addColumn<QString>("dead_label");
+        QTest::addColumn<QString>("expected_keyboard");
+
+        QTest::newRow("Plain keyboard")
+            << "general_test1" << false << 0 << "" << "|q|w|\n p a ";
+        QTest::newRow("Shifted keyboard ignores other modifiers")
+            << "general_test1" << true << 0 << "" << "|Q|W|\n p a ";
+        QTest::newRow("Dead keyboard")
+            << "general_test1" << false << 0 << ";" << "|q|r|\n p a ";
+        QTest::newRow("Shifted dead keyboard")
+            << "general_test1" << true << 0 << "'" << "|Q|T|\n p a ";
+        QTest::newRow("Second section")
+            << "general_test1_symbols" << false << 1 << "" << "|3|\n|4|";
+        QTest::newRow("Pages wrap around")
+            << "general_test1_symbols" << false << 2 << "" << "|1|\n|2|";
+    }
+
+    Q_SLOT void testKeyboardBuilder()
+    {
+        QFETCH(QString, keyboard_id);
+        QFETCH(bool, shifted);
+        QFETCH(int, page);
+        QFETCH(QString, dead_label);
+        QFETCH(QString, expected_keyboard);
+
+        QFile source(QString::fromLatin1(TEST_DATADIR) + "/languages/" + keyboard_id + ".xml");
+        QVERIFY(source.open(QIODevice::ReadOnly));
+        KeyboardBuilder builder(&source);
+        QVERIFY(builder.build(shifted, page, dead_label));
+
+        COMPARE_KEYBOARDS(builder.keyboard(), stringToKeyboard(expected_keyboard));
+    }
+
+    Q_SLOT void testKeyboardBuilderErrors_data()
+    {
+        QTest::addColumn<QByteArray>("document");
+        QTest::addColumn<int>("page");
+        QTest::addColumn<bool>("expected_result");
+
+        const QByteArray head("<keyboard version=\"1.0\"><layout type=\"general\">"
+                              "<section id=\"main\"><row><key><binding label=\"a\"/></key></row></section>");
+        const QByteArray invalid_value(head + "<section id=\"symbols\"><row><key width=\"huge\"><binding label=\"1\"/></key></row></section>"
+                                              "</layout></keyboard>");
+        const QByteArray malformed(head + "<section id=\"symbols\"><row><key></row></section></layout></keyboard>");
+        const QByteArray truncated(head + "<section id=\"symbols\"><row>");
+
+        QTest::newRow("Invalid value in the built section") << invalid_value << 1 << false;
+        QTest::newRow("Malformed XML in the built section") << malformed << 1 << false;
+        QTest::newRow("Truncated built section") << truncated << 1 << false;
+        // Reading stops after the built section; LayoutParser reports the rest:
+        QTest::newRow("Invalid value in a later section") << invalid_value << 0 << true;
+        QTest::newRow("Malformed XML in a later section") << malformed << 0 << true;
+        QTest::newRow("Truncated after the built section") << truncated << 0 << true;
+    }
+
+    Q_SLOT void testKeyboardBuilderErrors()
+    {
+        QFETCH(QByteArray, document);
+        QFETCH(int, page);
+        QFETCH(bool, expected_result);
+
+        QBuffer source(&document);
+        QVERIFY(source.open(QIODevice::ReadOnly));
+        KeyboardBuilder builder(&source);
+        QCOMPARE(builder.build(false, page), expected_result);
+        QCOMPARE(builder.errorString().isEmpty(), expected_result);
+    }
+
+    Q_SLOT void testPrefetch()
+    {
+        KeyboardVariantCache *const cache(KeyboardLoader::variantCache());
+        cache->invalidateAll();
+
+        SharedKeyboardLoader loader(new KeyboardLoader);
+        QSignalSpy prefetched_spy(loader.data(), SIGNAL(layoutPrefetched(QString)));
+
+        loader->setActiveId("extended_test");
+        // The active layout and duplicates are skipped:
+        loader->prefetch(QStringList() << "general_test1" << "extended_test"
+                                       << "action_test3" << "general_test1");
+        loader->waitForPrefetch();
+
+        // The layouts got prefetched and are announced on the GUI thread:
+        QTRY_COMPARE(prefetched_spy.count(), 2);
+        QCOMPARE(prefetched_spy.at(0).at(0).toString(), QString("general_test1"));
+        QCOMPARE(prefetched_spy.at(1).at(0).toString(), QString("action_test3"));
+
+        cache->resetStatistics();
+        loader->setActiveId("general_test1");
+        loader->keyboard();
+        loader->setActiveId("action_test3");
+        loader->keyboard();
+        QCOMPARE(cache->misses(), 0);
+        QCOMPARE(cache->hits(), 2);
+    }
+
+    Q_SLOT void testWarmUp()
+    {
+        const QStringList all_ids(QStringList() << "general_test1" << "extended_test");
+
+        QVERIFY(qputenv("MALIIT_KEYBOARD_WARMUP", "all"));
+        QCOMPARE(LayoutWarmUp::idsFromEnvironment(all_ids), all_ids);
+        QVERIFY(qputenv("MALIIT_KEYBOARD_WARMUP", "general_test1, does_not_exist"));
+        QCOMPARE(LayoutWarmUp::idsFromEnvironment(all_ids),
+                 QStringList() << "general_test1" << "does_not_exist");
+        QVERIFY(qputenv("MALIIT_KEYBOARD_WARMUP", ""));
+        QVERIFY(LayoutWarmUp::idsFromEnvironment(all_ids).isEmpty());
+        QVERIFY(qunsetenv("MALIIT_KEYBOARD_WARMUP"));
+        QVERIFY(LayoutWarmUp::idsFromEnvironment(all_ids).isEmpty());
+
+        KeyboardLoader::layoutCache()->invalidateAll();
+        // Too small for a layout and its imports, warm-up makes room:
+        KeyboardLoader::layoutCache()->setCapacity(1);
+
+        LayoutWarmUp warm_up;
+        QSignalSpy finished_spy(&warm_up, SIGNAL(finished()));
+
+        warm_up.start(QStringList() << "general_test1" << "does_not_exist");
+        QVERIFY(warm_up.waitForDone());
+        QTRY_COMPARE(finished_spy.count(), 1);
+        QVERIFY(not warm_up.isRunning());
+
+        const QList<LayoutWarmUpResult> results(warm_up.results());
+        QCOMPARE(results.size(), 2);
+
+        Q_FOREACH (const LayoutWarmUpResult &result, results) {
+            QCOMPARE(result.success(), result.id == "general_test1");
+        }
+
+        // The layout and its imports are cached now:
+        LayoutCache *const cache(KeyboardLoader::layoutCache());
+        QVERIFY(cache->capacity() > 1);
+        cache->resetStatistics();
+        SharedKeyboardLoader loader(getLoader("general_test1"));
+        loader->keyboard();
+        loader->symbolsKeyboard();
+        QCOMPARE(cache->misses(), 0);
+
+        cache->setCapacity(LayoutCache::DefaultCapacity);
+    }
+
+    Q_SLOT void testLanguageIndex()
+    {
+        const QString languages_dir(QString::fromLatin1(TEST_DATADIR) + "/languages");
+        const QString cache_file(QDir::temp().filePath("maliit-keyboard-test-languages.index"));
+        const QStringList expected_ids(QStringList()
+                                       << "action_test1" << "action_test2" << "action_test3"
+                                       << "extended_test" << "general_test1"
+                                       << "icon_test1" << "icon_test2" << "icon_test3"
+                                       << "styling_profile_test");
+
+        QFile::remove(cache_file);
+
+        LanguageIndex index(languages_dir, cache_file);
+        QCOMPARE(index.ids(), expected_ids);
+        QCOMPARE(index.ids(), expected_ids);
+        QCOMPARE(index.scans(), 1);
+
+        // Imported files are indexed, but are no languages:
+        QVERIFY(index.contains("general_test1_symbols"));
+        QVERIFY(not index.entry("general_test1_symbols").isLanguage());
+        QCOMPARE(index.title("general_test1"), QString("GeneralTest1"));
+        QCOMPARE(index.title("general_test1_numbers"), QString("GeneralTest1Numbers"));
+        QCOMPARE(index.title("does_not_exist"), QString());
+        QCOMPARE(index.entry("general_test1").symviews, QStringList("general_test1_symbols.xml"));
+
+        // Imports resolve to indexed layouts:
+        bool fallback(true);
+        QCOMPARE(index.resolveImport("general_test1", LanguageIndex::SymbolsImport, &fallback),
+                 QString("general_test1_symbols"));
+        QVERIFY(not fallback);
+        QCOMPARE(index.resolveImport("general_test1", LanguageIndex::PhoneNumberImport),
+                 QString("general_test1_phonenumbers"));
+        QCOMPARE(index.resolveImport("action_test1", LanguageIndex::SymbolsImport), QString());
+
+        // A second index is loaded from disk without scanning:
+        LanguageIndex stored_index(languages_dir, cache_file);
+        QCOMPARE(stored_index.ids(), expected_ids);
+        QCOMPARE(stored_index.title("general_test1"), QString("GeneralTest1"));
+        QCOMPARE(stored_index.scans(), 0);
+
+        stored_index.rebuild();
+        QCOMPARE(stored_index.ids(), expected_ids);
+        QCOMPARE(stored_index.scans(), 1);
+
+        QFile::remove(cache_file);
+
+        SharedKeyboardLoader loader(getLoader("general_test1"));
+        QCOMPARE(loader->ids(), expected_ids);
+        QCOMPARE(loader->title("general_test1"), QString("GeneralTest1"));
+    }
+
+    Q_SLOT void testTagArena()
+    {
+        TagKeyboardPtr keyboard;
+        QWeakPointer<TagArena> arena;
+
+        {
+            QFile source(QString::fromLatin1(TEST_DATADIR) + "/languages/extended_test.xml");
+            QVERIFY(source.open(QIODevice::ReadOnly));
+            LayoutParser parser(&source);
+            QVERIFY(parser.parse());
+
+            keyboard = parser.keyboard();
+            arena = parser.arena();
+            QVERIFY(parser.arena()->blockCount() > 0);
+            QVERIFY(parser.arena()->internedCount() > 0);
+
+            // Interning a QStringRef returns the already interned string:
+            const QString style(parser.arena()->intern(QString::fromLatin1("special")));
+            const QString text(QString::fromLatin1("nonspecial"));
+            QCOMPARE(parser.arena()->intern(text.midRef(3)).constData(), style.constData());
+        }
+
+        // The keyboard keeps the arena of its tags alive after the parser is gone ...
+        QVERIFY(not arena.isNull());
+        QCOMPARE(keyboard->title(), QString("ExtendedTest"));
+        QCOMPARE(keyboard->layouts().first()->sections().first()->rows().first()->elements().size(), 8);
+
+        // ... and it is released together with the keyboard.
+        keyboard.clear();
+        QVERIFY(arena.isNull());
+    }
+
+    Q_SLOT void testCompiledLayout_data()
+    {
+        QTest::addColumn<QString>("keyboard_id");
+
+        QTest::newRow("general") << "general_test1";
+        QTest::newRow("extended keys") << "extended_test";
+        QTest::newRow("actions") << "action_test1";
+    }
+
+    Q_SLOT void testCompiledLayout()
+    {
+        QFETCH(QString, keyboard_id);
+
+        QFile source(QString::fromLatin1(TEST_DATADIR) + "/languages/" + keyboard_id + ".xml");
+        QVERIFY(source.open(QIODevice::ReadOnly));
+        LayoutParser parser(&source);
+        QVERIFY(parser.parse());
+
+        QTemporaryFile blob;
+        QVERIFY(blob.open());
+        LayoutBlobWriter writer(&blob);
+        QVERIFY(writer.write(parser, source.size()));
+        QVERIFY(blob.flush());
+
+        LayoutBlobReader reader(&blob);
+        QVERIFY(reader.read(source.size()));
+        QCOMPARE(dumpKeyboard(reader.keyboard()), dumpKeyboard(parser.keyboard()));
+        QCOMPARE(reader.imports(), parser.imports());
+        QCOMPARE(reader.symviews(), parser.symviews());
+
+        // Blobs compiled from a different source are rejected:
+        LayoutBlobReader stale_reader(&blob);
+        QVERIFY(not stale_reader.read(source.size() + 1));
+        QVERIFY(not stale_reader.keyboard());
+
+        // LayoutCache prefers an up to date compiled layout over the source:
+        QTemporaryDir directory;
+        QVERIFY(directory.isValid());
+        const QString compiled_path(directory.path() + "/" + keyboard_id + CompiledLayoutSuffix);
+        QVERIFY(QFile::copy(source.fileName(), directory.path() + "/" + keyboard_id + ".xml"));
+        QVERIFY(QFile::copy(blob.fileName(), compiled_path));
+
+        LayoutCache cache(directory.path());
+        QVERIFY(cache.hasCompiledLayout(keyboard_id));
+        const SharedParsedLayout layout(cache.layout(keyboard_id));
+        QVERIFY(layout);
+        QCOMPARE(dumpKeyboard(layout->keyboard), dumpKeyboard(parser.keyboard()));
+
+        QVERIFY(QFile::remove(compiled_path));
+        QVERIFY(not cache.hasCompiledLayout(keyboard_id));
+    }
+
+    Q_SLOT void testCompactKey()
+    {
+        Font font;
+        font.setName("Sans");
+        font.setSize(12);
+
+        Key key;
+        key.rArea().setSize(QSize(10, 20));
+        key.rArea().setBackground("key.png");
+        key.rArea().setBackgroundBorders(QMargins(1, 2, 3, 4));
+        key.rLabel().setText("a");
+        key.rLabel().setFont(font);
+        key.setIcon("icon.png");
+
+        QCOMPARE(key.rect(), QRect(0, 0, 10, 20));
+        QCOMPARE(key.area().background(), QByteArray("key.png"));
+        QCOMPARE(key.area().backgroundBorders(), QMargins(1, 2, 3, 4));
+        QCOMPARE(key.label().text(), QString("a"));
+        QCOMPARE(key.label().font().name(), QByteArray("Sans"));
+        QCOMPARE(key.label().font().size(), 12);
+        QCOMPARE(key.icon(), QByteArray("icon.png"));
+
+        // Equal styling is stored only once:
+        const int backgrounds(KeyStyleTable::backgroundCount());
+        const int fonts(KeyStyleTable::fontCount());
+
+        Key other;
+        other.setArea(key.area());
+        other.setLabel(key.label());
+        other.setIcon(key.icon());
+        QCOMPARE(KeyStyleTable::backgroundCount(), backgrounds);
+        QCOMPARE(KeyStyleTable::fontCount(), fonts);
+        QVERIFY(other == key);
+
+        // References into the tables stay valid while they grow:
+        const QByteArray &icon(key.icon());
+        const Font &font(key.labelFont());
+
+        for (int index = 0; index < 300; ++index) {
+            KeyStyleTable::internIcon(QByteArray("icon-") + QByteArray::number(index));
+        }
+
+        QCOMPARE(icon, QByteArray("icon.png"));
+        QVERIFY(&key.icon() == &icon);
+        QVERIFY(&key.labelFont() == &font);
+    }
+
     Q_SLOT void testStylingProfile()
     {
         const Logic::LayoutHelper::Orientation orientation(Logic::LayoutHelper::Landscape);
@@ -572,6 +1049,24 @@ private:
         QCOMPARE(style.attributes()->fontSize(orientation), 10.0);
         QCOMPARE(style.extendedKeysAttributes()->fontSize(orientation), 0.0);
 
+        // Unknown style names fall back to the 'default' section:
+        StyleAttributes *const attributes(style.attributes());
+        attributes->setStyleName("does_not_exist");
+        QCOMPARE(attributes->keyWidth(orientation, KeyDescription::Large), 25.0);
+        QCOMPARE(attributes->keyWidth(Logic::LayoutHelper::Portrait, KeyDescription::Large), 56.0);
+        QCOMPARE(attributes->fontName(orientation), QByteArray("Nokia Pure"));
+        QCOMPARE(attributes->keyBackground(Key::StyleSpecialKey, KeyDescription::PressedState),
+                 QByteArray("key-background-special-pressed.png"));
+        QCOMPARE(attributes->icon(KeyDescription::ShiftLatchedIcon, KeyDescription::NormalState),
+                 QByteArray("shift-latched-icon.png"));
+        QCOMPARE(attributes->customIcon("square-smiley"), QByteArray("square-smile.png"));
+        QCOMPARE(attributes->keyBackgroundBorders(), QMargins(2, 2, 2, 2));
+
+        const KeyBackground &pressed(attributes->keyStateBackground(Key::StyleNormalKey,
+                                                                    KeyDescription::PressedState));
+        QCOMPARE(pressed.image, QByteArray("key-background-pressed.png"));
+        QCOMPARE(pressed.borders, QMargins(2, 2, 2, 2));
+
         const QString test_profile_dir(QString::fromLatin1(TEST_MALIIT_KEYBOARD_DATADIR)
                                        + "/styles/test-profile");
         QCOMPARE(style.directory(Style::Images), test_profile_dir + "/images");
@@ -614,11 +1109,70 @@ private:
         const Key key(key_area.keys().at(key_index));
 
         QCOMPARE(key.label().text(), expected_label);
+        QCOMPARE(key.id(), static_cast<quint16>(key_index + 1));
         QCOMPARE(key.margins().left(), expected_left_distance);
         QCOMPARE(key.margins().right(), expected_right_distance);
         QCOMPARE(key.rect().x(), expected_left_edge);
         QCOMPARE(key.rect().x() + key.rect().width(), expected_right_edge);
     }
+
+    Q_SLOT void testKeyIds()
+    {
+        Style style;
+        style.setProfile("test-profile");
+        SharedKeyboardLoader loader(getLoader("general_test1"));
+        Logic::KeyAreaConverter converter(style.attributes(), loader.data());
+
+        const QVector<Key> keys(converter.keyArea().keys());
+        const QVector<Key> shifted_keys(converter.shiftedKeyArea().keys());
+        QSet<quint16> ids;
+
+        // Shifting shows the same keys:
+        QCOMPARE(shifted_keys.size(), keys.size());
+        for (int index = 0; index < keys.size(); ++index) {
+            QVERIFY(keys.at(index).id() != 0);
+            QCOMPARE(shifted_keys.at(index).id(), keys.at(index).id());
+            ids.insert(keys.at(index).id());
+        }
+        QCOMPARE(ids.size(), keys.size());
+
+        // Keys of other key areas of the layout get other identifiers:
+        const QVector<Key> other_keys(converter.symbolsKeyArea(0).keys()
+                                      + converter.symbolsKeyArea(1).keys()
+                                      + converter.numberKeyArea().keys());
+        QVERIFY(not other_keys.isEmpty());
+        Q_FOREACH (const Key &key, other_keys) {
+            QVERIFY(key.id() != 0);
+            QVERIFY(not ids.contains(key.id()));
+            ids.insert(key.id());
+        }
+        QCOMPARE(ids.size(), keys.size() + other_keys.size());
+
+        // Active keys are tracked by identifier:
+        QVERIFY(keys.size() >= 3);
+        Logic::LayoutHelper helper;
+        helper.appendActiveKey(keys.at(0));
+        helper.appendActiveKey(keys.at(1));
+        helper.appendActiveKey(keys.at(2));
+        helper.appendActiveKey(keys.at(0));
+        QCOMPARE(helper.activeKeys().size(), 3);
+
+        // A key held down twice stays active until released twice:
+        helper.removeActiveKey(keys.at(0));
+        QCOMPARE(helper.activeKeys().size(), 3);
+        helper.removeActiveKey(keys.at(0));
+        QCOMPARE(helper.activeKeys().size(), 2);
+
+        helper.removeActiveKey(keys.at(1));
+        helper.removeActiveKey(keys.at(1));
+        QCOMPARE(helper.activeKeys().size(), 1);
+        QCOMPARE(helper.activeKeys().first().id(), keys.at(2).id());
+
+        helper.clearActiveKeys();
+        QVERIFY(helper.activeKeys().isEmpty());
+        helper.removeActiveKey(keys.at(2));
+        QVERIFY(helper.activeKeys().isEmpty());
+    }
 };
 
 QTEST_MAIN(TestLanguageLayoutLoading)
@@ -33,6 +33,8 @@
 #include "utils.h"
 #include "models/key.h"
 #include "models/keyarea.h"
+#include "models/layout.h"
+#include "models/imageatlas.h"
 #include "logic/layouthelper.h"
 #include "plugin/editor.h"
 #include "logic/layoutupdater.h"
@@ -85,6 +87,249 @@ private:
         QCOMPARE(layout.activeKeyArea().keys().count(), expected_key_count);
     }
 
+    Q_SLOT void testKeyAreaCache()
+    {
+        Logic::LayoutUpdater layout_updater;
+
+        Logic::LayoutHelper layout(new Logic::LayoutHelper);
+        layout_updater.setLayout(&layout);
+
+        SharedStyle style(new Style);
+        layout_updater.setStyle(style);
+
+        layout_updater.setActiveKeyboardId("en_gb");
+        TestUtils::waitForSignal(&layout, SIGNAL(centerPanelChanged(KeyArea,Logic::KeyOverrides)));
+
+        const int main_key_count(layout.activeKeyArea().keys().count());
+
+        // Toggling between main and symbols view converts each key area once:
+        QVERIFY(QMetaObject::invokeMethod(&layout_updater, "switchToPrimarySymView"));
+        const int misses(layout_updater.keyAreaCacheMisses());
+        const int hits(layout_updater.keyAreaCacheHits());
+
+        QVERIFY(QMetaObject::invokeMethod(&layout_updater, "switchToMainView"));
+        QVERIFY(QMetaObject::invokeMethod(&layout_updater, "switchToPrimarySymView"));
+        QVERIFY(QMetaObject::invokeMethod(&layout_updater, "switchToMainView"));
+        QCOMPARE(layout_updater.keyAreaCacheMisses(), misses);
+        QCOMPARE(layout_updater.keyAreaCacheHits(), hits + 3);
+        QCOMPARE(layout.activeKeyArea().keys().count(), main_key_count);
+
+        // Rotating converts again, but only once per orientation:
+        layout_updater.setOrientation(Logic::LayoutHelper::Portrait);
+        layout_updater.setOrientation(Logic::LayoutHelper::Landscape);
+        layout_updater.setOrientation(Logic::LayoutHelper::Portrait);
+        QCOMPARE(layout_updater.keyAreaCacheMisses(), misses + 1);
+
+        // A new style profile invalidates all key areas:
+        style->setProfile(style->profile());
+        QVERIFY(QMetaObject::invokeMethod(&layout_updater, "switchToMainView"));
+        QCOMPARE(layout_updater.keyAreaCacheMisses(), misses + 2);
+    }
+
+    Q_SLOT void testReplaceKey()
+    {
+        Key a;
+        a.rLabel().setText("a");
+        a.rArea().setBackground("key-background.png");
+
+        Key b(a);
+        b.rLabel().setText("b");
+
+        KeyArea key_area;
+        key_area.rKeys().append(a);
+        key_area.rKeys().append(b);
+
+        Model::Layout layout;
+        layout.setImageDirectory("/tmp");
+        layout.setKeyArea(key_area);
+        QCOMPARE(layout.data(1, "key_background").toUrl(), QUrl("/tmp/key-background.png"));
+
+        qRegisterMetaType<QVector<int> >();
+        QSignalSpy data_changed(&layout, SIGNAL(dataChanged(QModelIndex,QModelIndex,QVector<int>)));
+
+        Key pressed_b(b);
+        pressed_b.setState(KeyDescription::PressedState);
+        pressed_b.rArea().setBackground("key-background-pressed.png");
+
+        // Only the changed roles are announced:
+        layout.replaceKey(1, pressed_b);
+        QCOMPARE(data_changed.count(), 1);
+        QCOMPARE(data_changed.first().at(2).value<QVector<int> >(),
+                 QVector<int>() << Model::Layout::RoleKeyBackground);
+        QVERIFY(layout.key(1) == pressed_b);
+        QVERIFY(layout.keyArea().keys().at(1) == pressed_b);
+        QCOMPARE(layout.data(1, "key_background").toUrl(), QUrl("/tmp/key-background-pressed.png"));
+
+        // The shared key area itself stays untouched:
+        QVERIFY(key_area.keys().at(1) == b);
+
+        // Restoring the original key drops the override, and only emits once:
+        layout.replaceKey(1, b);
+        layout.replaceKey(1, b);
+        QCOMPARE(data_changed.count(), 2);
+        QVERIFY(layout.key(1) == b);
+        QVERIFY(layout.key(0) == a);
+        QCOMPARE(layout.data(1, "key_background").toUrl(), QUrl("/tmp/key-background.png"));
+
+        // A key which only differs in its state looks the same:
+        Key pressed_a(a);
+        pressed_a.setState(KeyDescription::PressedState);
+        layout.replaceKey(0, pressed_a);
+        QCOMPARE(data_changed.count(), 2);
+        QVERIFY(layout.key(0) == pressed_a);
+
+        // Image providers get absolute file names as ids:
+        layout.setImageProvider("maliit-style");
+        QCOMPARE(layout.data(1, "key_background").toUrl(),
+                 QUrl("image://maliit-style/tmp/key-background.png"));
+    }
+
+    Q_SLOT void testShiftLabelSwap()
+    {
+        Key a;
+        a.rArea().setSize(QSize(10, 10));
+        a.rLabel().setText("a");
+
+        Key b(a);
+        b.setOrigin(QPoint(10, 0));
+        b.rLabel().setText("b");
+
+        Key shifted_a(a);
+        shifted_a.rLabel().setText("A");
+
+        KeyArea key_area;
+        key_area.setId("general_test1/0");
+        key_area.rKeys() << a << b;
+
+        KeyArea shifted_key_area(key_area);
+        shifted_key_area.rKeys()[0] = shifted_a;
+
+        Model::Layout layout;
+        layout.setKeyArea(key_area);
+
+        QSignalSpy reset(&layout, SIGNAL(modelReset()));
+        QSignalSpy data_changed(&layout, SIGNAL(dataChanged(QModelIndex,QModelIndex)));
+
+        // Same geometry: only the changed label is updated.
+        layout.setKeyArea(shifted_key_area);
+        QCOMPARE(reset.count(), 0);
+        QCOMPARE(data_changed.count(), 1);
+        QCOMPARE(data_changed.first().at(0).value<QModelIndex>().row(), 0);
+        QCOMPARE(data_changed.first().at(1).value<QModelIndex>().row(), 0);
+        QCOMPARE(layout.data(0, "key_text").toString(), QString("A"));
+        QCOMPARE(layout.data(1, "key_text").toString(), QString("b"));
+
+        // Fewer keys: surplus rows are removed instead of resetting the model.
+        QSignalSpy removed(&layout, SIGNAL(rowsRemoved(QModelIndex,int,int)));
+        KeyArea single_key_area;
+        single_key_area.setId("general_test1/0");
+        single_key_area.rKeys() << a;
+        layout.setKeyArea(single_key_area);
+        QCOMPARE(reset.count(), 0);
+        QCOMPARE(removed.count(), 1);
+        QCOMPARE(removed.first().at(1).toInt(), 1);
+        QCOMPARE(layout.rowCount(), 1);
+        QCOMPARE(layout.data(0, "key_text").toString(), QString("a"));
+
+        // Neither scaling nor a new image directory reset the model:
+        QCOMPARE(layout.data(0, "key_reactive_area").toRectF(), QRectF(0, 0, 10, 10));
+        layout.setScaleRatio(2);
+        layout.setImageDirectory("/tmp");
+        QCOMPARE(reset.count(), 0);
+        QCOMPARE(layout.data(0, "key_reactive_area").toRectF(), QRectF(0, 0, 20, 20));
+
+        // Key areas of another layout or section reset the model, even
+        // with the same geometry:
+        KeyArea other_key_area(key_area);
+        other_key_area.setId("general_test1/6");
+        layout.setKeyArea(other_key_area);
+        QCOMPARE(reset.count(), 1);
+        QCOMPARE(removed.count(), 1);
+        QCOMPARE(layout.rowCount(), 2);
+        QCOMPARE(layout.data(1, "key_text").toString(), QString("b"));
+    }
+
+    Q_SLOT void testKeyIndexAt()
+    {
+        // .-----------.
+        // | a |   b   |
+        // |---+-------|
+        // |   c   |   |
+        // `-----------'
+        KeyArea key_area;
+        const QRect rects[] = {QRect(0, 0, 10, 10), QRect(10, 0, 20, 10), QRect(0, 10, 20, 10)};
+
+        for (int index = 0; index < 3; ++index) {
+            Key key;
+            key.setOrigin(rects[index].topLeft());
+            key.rArea().setSize(rects[index].size());
+            key_area.rKeys().append(key);
+        }
+
+        Model::Layout layout;
+        layout.setKeyArea(key_area);
+
+        QCOMPARE(layout.keyIndexAt(QPointF(0, 0)), 0);
+        QCOMPARE(layout.keyIndexAt(QPointF(9.5, 9.5)), 0);
+        QCOMPARE(layout.keyIndexAt(QPointF(10, 0)), 1);
+        QCOMPARE(layout.keyIndexAt(QPointF(29, 9)), 1);
+        QCOMPARE(layout.keyIndexAt(QPointF(19, 19)), 2);
+        QCOMPARE(layout.keyIndexAt(QPointF(25, 15)), -1);
+        QCOMPARE(layout.keyIndexAt(QPointF(-1, 5)), -1);
+
+        // Positions are in scaled coordinates:
+        layout.setScaleRatio(2);
+        QCOMPARE(layout.keyIndexAt(QPointF(25, 5)), 1);
+        QCOMPARE(layout.keyIndexAt(QPointF(5, 25)), 2);
+    }
+
+    Q_SLOT void testImageAtlas()
+    {
+        QMap<QByteArray, QSize> sizes;
+        sizes.insert("key-background.png", QSize(40, 50));
+        sizes.insert("key-background-pressed.png", QSize(40, 50));
+        sizes.insert("shift-icon.png", QSize(20, 20));
+        sizes.insert("background.png", QSize(100, 10));
+
+        ImageAtlas atlas(ImageAtlas::pack(sizes, 1));
+        QVERIFY(not atlas.isValid()); // No image file yet.
+        QCOMPARE(atlas.images().count(), sizes.count());
+
+        // Images keep their size, stay inside the atlas and keep their
+        // padding to each other:
+        const QRect bounds(QPoint(), atlas.size());
+
+        Q_FOREACH (const QByteArray &image, atlas.images()) {
+            const QRect &rect(atlas.rect(image));
+            QCOMPARE(rect.size(), sizes.value(image));
+            QVERIFY(bounds.contains(rect.adjusted(-1, -1, 1, 1)));
+
+            Q_FOREACH (const QByteArray &other, atlas.images()) {
+                if (other != image) {
+                    QVERIFY(not rect.adjusted(-1, -1, 1, 1).intersects(atlas.rect(other)));
+                }
+            }
+        }
+
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+
+        atlas.setFileName(QDir(dir.path()).absoluteFilePath("atlas.png"));
+        QVERIFY(atlas.isValid());
+
+        const QString table(QDir(dir.path()).absoluteFilePath(ImageAtlasTableFileName));
+        QVERIFY(atlas.save(table));
+        QVERIFY(ImageAtlas::load(table) == atlas);
+        QVERIFY(not ImageAtlas::load(QDir(dir.path()).absoluteFilePath("missing.ini")).isValid());
+
+        Model::Layout layout;
+        QSignalSpy atlas_changed(&layout, SIGNAL(imageAtlasChanged()));
+        layout.setImageAtlas(atlas);
+        layout.setImageAtlas(atlas);
+        QCOMPARE(atlas_changed.count(), 1);
+        QVERIFY(layout.imageAtlas().rect("shift-icon.png") == atlas.rect("shift-icon.png"));
+    }
+
     // This test is very trivial. It's required however because none of the
     // current mainline layouts feature layout switch keys, thus making
     // regressions impossible to spot.
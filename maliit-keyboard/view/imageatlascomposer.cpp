@@ -0,0 +1,140 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012-2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "imageatlascomposer.h"
+
+namespace MaliitKeyboard {
+
+//! File name of the atlas image stored next to the images of a style
+//! profile.
+const char *const ImageAtlasImageFileName = "atlas.png";
+
+namespace {
+
+//! Repeats the outermost pixels of an image into its padding, so that
+//! linear filtering at the image's edges samples the image itself.
+void extrudeEdges(QPainter *painter,
+                  const QImage &image,
+                  const QRect &rect,
+                  int padding)
+{
+    const int w(image.width());
+    const int h(image.height());
+
+    for (int offset = 1; offset <= padding; ++offset) {
+        painter->drawImage(QPoint(rect.left() - offset, rect.top()), image, QRect(0, 0, 1, h));
+        painter->drawImage(QPoint(rect.right() + offset, rect.top()), image, QRect(w - 1, 0, 1, h));
+        painter->drawImage(QPoint(rect.left(), rect.top() - offset), image, QRect(0, 0, w, 1));
+        painter->drawImage(QPoint(rect.left(), rect.bottom() + offset), image, QRect(0, h - 1, w, 1));
+    }
+
+    const QRect corners[] = {
+        QRect(rect.left() - padding, rect.top() - padding, padding, padding),
+        QRect(rect.right() + 1, rect.top() - padding, padding, padding),
+        QRect(rect.left() - padding, rect.bottom() + 1, padding, padding),
+        QRect(rect.right() + 1, rect.bottom() + 1, padding, padding),
+    };
+    const QPoint corner_pixels[] = {
+        QPoint(0, 0), QPoint(w - 1, 0), QPoint(0, h - 1), QPoint(w - 1, h - 1),
+    };
+
+    for (int index = 0; index < 4; ++index) {
+        painter->fillRect(corners[index], QColor::fromRgba(image.pixel(corner_pixels[index])));
+    }
+}
+
+} // namespace
+
+//! \brief Packs all PNG images of a style profile into one atlas image.
+//!
+//! Used by the atlas compiler at build time, and by renderers at runtime
+//! for profiles that ship no atlas.
+//! \param directory The images directory of the style profile.
+//! \param atlas Receives the coordinate table. Its file name is the atlas
+//!              image inside directory.
+//! \returns The atlas image, or a null image if directory has no images.
+QImage composeImageAtlas(const QString &directory,
+                         ImageAtlas *atlas)
+{
+    const int padding(1);
+    const QDir dir(directory);
+    QMap<QByteArray, QImage> images;
+    QMap<QByteArray, QSize> sizes;
+
+    Q_FOREACH (const QString &file_name, dir.entryList(QStringList() << "*.png", QDir::Files, QDir::Name)) {
+        if (file_name == ImageAtlasImageFileName) {
+            continue;
+        }
+
+        const QImage image(dir.absoluteFilePath(file_name));
+
+        if (image.isNull()) {
+            qWarning() << __PRETTY_FUNCTION__
+                       << "Cannot decode image:" << dir.absoluteFilePath(file_name);
+            continue;
+        }
+
+        images.insert(file_name.toLatin1(), image);
+        sizes.insert(file_name.toLatin1(), image.size());
+    }
+
+    ImageAtlas packed(ImageAtlas::pack(sizes, padding));
+    packed.setFileName(dir.absoluteFilePath(ImageAtlasImageFileName));
+
+    if (atlas) {
+        *atlas = packed;
+    }
+
+    if (not packed.isValid()) {
+        return QImage();
+    }
+
+    QImage result(packed.size(), QImage::Format_ARGB32_Premultiplied);
+    result.fill(Qt::transparent);
+
+    QPainter painter(&result);
+    painter.setCompositionMode(QPainter::CompositionMode_Source);
+
+    for (QMap<QByteArray, QImage>::const_iterator it = images.constBegin();
+         it != images.constEnd();
+         ++it) {
+        const QRect &rect(packed.rect(it.key()));
+
+        painter.drawImage(rect.topLeft(), it.value());
+        extrudeEdges(&painter, it.value(), rect, padding);
+    }
+
+    painter.end();
+
+    return result;
+}
+
+} // namespace MaliitKeyboard
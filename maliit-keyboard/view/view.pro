@@ -21,11 +21,13 @@ HEADERS += \
     abstractfeedback.h \
     nullfeedback.h \
     surface.h \
+    imageatlascomposer.h \
 
 SOURCES += \
     abstractfeedback.cpp \
     nullfeedback.cpp \
     surface.cpp \
+    imageatlascomposer.cpp \
 
 enable-qt-mobility {
     HEADERS += soundfeedback.h
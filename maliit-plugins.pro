@@ -9,6 +9,8 @@ include(config.pri)
         \\n\\t LIBDIR: Library install directory. Default: $$PREFIX/lib \
         \\n\\t MALIIT_DEFAULT_PROFILE: Default keyboard style. Default: nokia-n9 \
         \\n\\t HUNSPELL_DICT_PATH: Path to hunspell dictionaries. Default: $$PREFIX/share/hunspell \
+        \\n\\t LAYOUT_COMPILER: Host build of maliit-keyboard-layout-compiler, for cross-compiling. Default: the one built in-tree \
+        \\n\\t ATLAS_COMPILER: Host build of maliit-keyboard-atlas-compiler, for cross-compiling. Default: the one built in-tree \
         \\nRecognised CONFIG flags: \
         \\n\\t enable-presage: Use presage to calculate word candidates (maliit-keyboard-plugin only) \
         \\n\\t enable-hunspell: Use hunspell for error correction (maliit-keyboard-plugin only) \
@@ -18,6 +20,7 @@ include(config.pri)
         \\n\\t nodoc: Do not build documentation \
         \\n\\t disable-maliit-keyboard: Do not build the C++ reference keyboard (Maliit Keyboard) \
         \\n\\t disable-nemo-keyboard: Do not build the QML reference keyboard (Nemo Keyboard) \
+        \\n\\t disable-precompiled-data: Do not precompile layouts or pack style images into atlases at build time (maliit-keyboard-plugin only) \
         \\n\\t disable-background-translucency : Do not set translucent background hint on surfaces (workaround for non-compositing WMs) \
         \\nInfluential environment variables: \
         \\n\\t QMAKEFEATURES A mkspecs/features directory list to look for features. \